@@ -31,6 +31,7 @@ void topologicalSortUtil(Graph graph, int vertex, int *visited, Stack* stack,int
 void topologicalSort(Graph graph) {
     Stack* stack = createStack();
     int N = graph.numberVertices;
+    stackReserve(stack, N);
     int *visited = (int*)malloc(N * sizeof(int));
     for (int i = 0; i < N; i++) {
         visited[i] = 0;
@@ -44,7 +45,7 @@ void topologicalSort(Graph graph) {
         graph.topological_ordering[i] = pop(stack);
     }
     free(visited);
-    free(stack);
+    destroyStack(stack);
 }
 
 
@@ -278,6 +278,8 @@ void graphDFS(Graph graph, int vertex) {
     }
 
     Stack* stack = createStack();
+    // each vertex is pushed at most once
+    stackReserve(stack, graph.numberVertices);
 
     visited[vertex] = 1;
     push(stack, vertex);
@@ -303,6 +305,7 @@ void graphDFS(Graph graph, int vertex) {
         }
     }
 
+    destroyStack(stack);
     free(visited);
     return;
 }
@@ -325,6 +328,8 @@ void graphBFS(Graph graph, int vertex){
         visited[i] = 0;
     }
     Queue* queue = createQueue();
+    // each vertex is added at most once
+    queueReserve(queue, graph.numberVertices);
     enqueue(queue, vertex);
     visited[vertex] = 1;
 
@@ -342,6 +347,7 @@ void graphBFS(Graph graph, int vertex){
             temp = temp->nextCell;
         }
     }
+    destroyQueue(queue);
     free(visited);
     return;
 }
@@ -0,0 +1,372 @@
+/**
+ * @file concurrenthashtable.c
+ * @brief Source file for a concurrent hash table whose lookups take no lock
+ *
+ * Ordering of the memory accesses: a reader writes its epoch in its slot,
+ * then executes a full fence before reading the table. A writer unlinks a
+ * cell (or publishes a new table), executes a full fence and increments the
+ * epoch before reading the slots of the readers. Either the fence of the
+ * reader comes first, and the writer sees that the reader is in a lookup
+ * and waits for it, or the fence of the writer comes first, and the reader
+ * cannot reach the unlinked cell.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "concurrenthashtable.h"
+
+/**
+ * @brief Allocates an empty table of lists
+ *
+ * @param sizeTable the number of lists, a power of two
+ * @return the table
+ */
+static ConcurrentTable *concurrentTableCreate(size_t sizeTable) {
+    ConcurrentTable *table = (ConcurrentTable *)malloc(sizeof(ConcurrentTable));
+    table->sizeTable = sizeTable;
+    table->lists = (ConcurrentCell *_Atomic *)malloc(sizeTable * sizeof(ConcurrentCell *_Atomic));
+    for (size_t i = 0; i < sizeTable; i++) {
+        atomic_init(&table->lists[i], NULL);
+    }
+    return table;
+}
+
+/**
+ * @brief Frees a table and all the cells of its lists
+ *
+ * @param table the table, that no reader can reach any more
+ */
+static void concurrentTableFree(ConcurrentTable *table) {
+    for (size_t i = 0; i < table->sizeTable; i++) {
+        ConcurrentCell *cell = atomic_load_explicit(&table->lists[i], memory_order_relaxed);
+        while (cell != NULL) {
+            ConcurrentCell *next = atomic_load_explicit(&cell->nextCell, memory_order_relaxed);
+            free(cell);
+            cell = next;
+        }
+    }
+    free(table->lists);
+    free(table);
+}
+
+/**
+ * @brief Allocates a cell that is not published yet
+ *
+ * @return the cell, whose next cell is NULL
+ */
+static ConcurrentCell *concurrentCellCreate(string key, size_t sizeKey, uint32_t hash, int value) {
+    ConcurrentCell *cell = (ConcurrentCell *)malloc(sizeof(ConcurrentCell) + sizeKey + 1);
+    atomic_init(&cell->nextCell, NULL);
+    atomic_init(&cell->value, value);
+    cell->hash = hash;
+    cell->sizeKey = sizeKey;
+    cell->nextRetired = NULL;
+    memcpy(cell->key, key, sizeKey);
+    cell->key[sizeKey] = '\0';
+    return cell;
+}
+
+/**
+ * @brief Searches a key in a table
+ *
+ * Called by the readers (between concurrentReaderEnter and
+ * concurrentReaderExit) and by the writers.
+ *
+ * @return the cell of the key, NULL if the key is not in the table
+ */
+static ConcurrentCell *concurrentFindCell(ConcurrentTable *table, string key, size_t sizeKey, uint32_t hash) {
+    ConcurrentCell *cell = atomic_load_explicit(&table->lists[hash & (table->sizeTable - 1)], memory_order_acquire);
+    while (cell != NULL) {
+        if (cell->hash == hash && cell->sizeKey == sizeKey && memcmp(cell->key, key, sizeKey) == 0) {
+            return cell;
+        }
+        cell = atomic_load_explicit(&cell->nextCell, memory_order_acquire);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Marks the beginning of a lookup of a reader
+ */
+static inline void concurrentReaderEnter(ConcurrentHashTable *hashtable, int reader) {
+    uint64_t epoch = atomic_load_explicit(&hashtable->epoch, memory_order_relaxed);
+    atomic_store_explicit(&hashtable->readers[reader].epoch, epoch, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+/**
+ * @brief Marks the end of a lookup of a reader
+ */
+static inline void concurrentReaderExit(ConcurrentHashTable *hashtable, int reader) {
+    atomic_store_explicit(&hashtable->readers[reader].epoch, 0, memory_order_release);
+}
+
+/**
+ * @brief Waits for a grace period: every lookup started before the call
+ * is finished when the function returns
+ *
+ * Called by a writer, with the lock of the writers.
+ *
+ * @param hashtable the hash table
+ */
+static void concurrentSynchronize(ConcurrentHashTable *hashtable) {
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t epoch = atomic_fetch_add_explicit(&hashtable->epoch, 1, memory_order_relaxed) + 1;
+    for (int i = 0; i < CONCURRENT_HASHTABLE_MAX_READERS; i++) {
+        for (;;) {
+            uint64_t readerEpoch = atomic_load_explicit(&hashtable->readers[i].epoch, memory_order_acquire);
+            // a lookup that started after the increment cannot see the unlinked cells
+            if (readerEpoch == 0 || readerEpoch >= epoch) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief Frees the removed cells after a grace period
+ *
+ * Called by a writer, with the lock of the writers.
+ *
+ * @param hashtable the hash table
+ */
+static void concurrentFreeRetiredCells(ConcurrentHashTable *hashtable) {
+    concurrentSynchronize(hashtable);
+    while (hashtable->retiredCells != NULL) {
+        ConcurrentCell *next = hashtable->retiredCells->nextRetired;
+        free(hashtable->retiredCells);
+        hashtable->retiredCells = next;
+    }
+    hashtable->nbRetiredCells = 0;
+}
+
+/**
+ * @brief Doubles the size of the table
+ *
+ * The cells are copied into a new table, which is published at once: the
+ * readers traverse either the old lists or the new ones, never a mix of
+ * them. The old table is freed after a grace period.
+ * Called by a writer, with the lock of the writers.
+ *
+ * @param hashtable the hash table
+ * @return the new table
+ */
+static ConcurrentTable *concurrentGrow(ConcurrentHashTable *hashtable) {
+    ConcurrentTable *oldTable = atomic_load_explicit(&hashtable->table, memory_order_relaxed);
+    ConcurrentTable *table = concurrentTableCreate(2 * oldTable->sizeTable);
+    for (size_t i = 0; i < oldTable->sizeTable; i++) {
+        ConcurrentCell *cell = atomic_load_explicit(&oldTable->lists[i], memory_order_relaxed);
+        while (cell != NULL) {
+            ConcurrentCell *copy = concurrentCellCreate(cell->key, cell->sizeKey, cell->hash,
+                                                        atomic_load_explicit(&cell->value, memory_order_relaxed));
+            size_t index = copy->hash & (table->sizeTable - 1);
+            atomic_init(&copy->nextCell, atomic_load_explicit(&table->lists[index], memory_order_relaxed));
+            atomic_init(&table->lists[index], copy);
+            cell = atomic_load_explicit(&cell->nextCell, memory_order_relaxed);
+        }
+    }
+    atomic_store_explicit(&hashtable->table, table, memory_order_release);
+    concurrentFreeRetiredCells(hashtable);
+    concurrentTableFree(oldTable);
+    return table;
+}
+
+
+/**
+ * Create a new concurrent hash table.
+ *
+ * @param sizeTable the initial size of the table, rounded up to a power of two
+ * @return a pointer on the empty hash table, to destroy with concurrentHashtableDestroy
+ */
+ConcurrentHashTable *concurrentHashtableCreate(size_t sizeTable) {
+    size_t size = 1;
+    while (size < sizeTable) {
+        size *= 2;
+    }
+    ConcurrentHashTable *hashtable = (ConcurrentHashTable *)malloc(sizeof(ConcurrentHashTable));
+    atomic_init(&hashtable->table, concurrentTableCreate(size));
+    hashtable->readers = (ConcurrentReader *)aligned_alloc(CONCURRENT_HASHTABLE_ALIGNMENT,
+                                                           CONCURRENT_HASHTABLE_MAX_READERS * sizeof(ConcurrentReader));
+    for (int i = 0; i < CONCURRENT_HASHTABLE_MAX_READERS; i++) {
+        atomic_init(&hashtable->readers[i].epoch, 0);
+        atomic_init(&hashtable->readers[i].registered, 0);
+    }
+    atomic_init(&hashtable->epoch, 1);
+    pthread_mutex_init(&hashtable->writeLock, NULL);
+    hashtable->numberOfPairs = 0;
+    hashtable->retiredCells = NULL;
+    hashtable->nbRetiredCells = 0;
+    return hashtable;
+}
+
+
+/**
+ * Free the memory used by the concurrent hash table.
+ * @param hashtable hash table to free
+ */
+void concurrentHashtableDestroy(ConcurrentHashTable *hashtable) {
+    concurrentTableFree(atomic_load_explicit(&hashtable->table, memory_order_relaxed));
+    while (hashtable->retiredCells != NULL) {
+        ConcurrentCell *next = hashtable->retiredCells->nextRetired;
+        free(hashtable->retiredCells);
+        hashtable->retiredCells = next;
+    }
+    free(hashtable->readers);
+    pthread_mutex_destroy(&hashtable->writeLock);
+    free(hashtable);
+}
+
+
+/**
+ * Register the calling thread as a reader of the hash table.
+ *
+ * @param hashtable the hash table
+ * @return the identifier of the reader, -1 if there is no free slot
+ */
+int concurrentHashtableRegisterReader(ConcurrentHashTable *hashtable) {
+    for (int i = 0; i < CONCURRENT_HASHTABLE_MAX_READERS; i++) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&hashtable->readers[i].registered, &expected, 1)) {
+            return i;
+        }
+    }
+    printf("Error:too many readers\n");
+    return -1;
+}
+
+
+/**
+ * Give back the slot of a reader, that will do no more lookups.
+ * @param hashtable the hash table
+ * @param reader the identifier of the reader
+ */
+void concurrentHashtableUnregisterReader(ConcurrentHashTable *hashtable, int reader) {
+    atomic_store_explicit(&hashtable->readers[reader].epoch, 0, memory_order_release);
+    atomic_store(&hashtable->readers[reader].registered, 0);
+}
+
+
+/**
+ * Insert a new key-value pair into the hash table, or replace the value
+ * if the key is already in the hash table.
+ *
+ * @param hashtable pointer on the hash table to insert into
+ * @param key the key for the new pair
+ * @param value the value for the new pair
+ */
+void concurrentHashtableInsert(ConcurrentHashTable *hashtable, string key, int value) {
+    size_t sizeKey = strlen(key);
+    uint32_t hash = murmurhash32(key, sizeKey);
+    pthread_mutex_lock(&hashtable->writeLock);
+    ConcurrentTable *table = atomic_load_explicit(&hashtable->table, memory_order_relaxed);
+    ConcurrentCell *cell = concurrentFindCell(table, key, sizeKey, hash);
+    if (cell != NULL) {
+        atomic_store_explicit(&cell->value, value, memory_order_relaxed);
+    }
+    else {
+        if (hashtable->numberOfPairs >= table->sizeTable) {
+            table = concurrentGrow(hashtable);
+        }
+        size_t index = hash & (table->sizeTable - 1);
+        cell = concurrentCellCreate(key, sizeKey, hash, value);
+        atomic_init(&cell->nextCell, atomic_load_explicit(&table->lists[index], memory_order_relaxed));
+        // the cell is complete before it can be reached
+        atomic_store_explicit(&table->lists[index], cell, memory_order_release);
+        hashtable->numberOfPairs++;
+    }
+    pthread_mutex_unlock(&hashtable->writeLock);
+}
+
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int concurrentHashtableRemove(ConcurrentHashTable *hashtable, string key) {
+    size_t sizeKey = strlen(key);
+    uint32_t hash = murmurhash32(key, sizeKey);
+    pthread_mutex_lock(&hashtable->writeLock);
+    ConcurrentTable *table = atomic_load_explicit(&hashtable->table, memory_order_relaxed);
+    ConcurrentCell *_Atomic *previous = &table->lists[hash & (table->sizeTable - 1)];
+    ConcurrentCell *cell = atomic_load_explicit(previous, memory_order_relaxed);
+    while (cell != NULL
+           && !(cell->hash == hash && cell->sizeKey == sizeKey && memcmp(cell->key, key, sizeKey) == 0)) {
+        previous = &cell->nextCell;
+        cell = atomic_load_explicit(previous, memory_order_relaxed);
+    }
+    if (cell == NULL) {
+        pthread_mutex_unlock(&hashtable->writeLock);
+        return 0;
+    }
+    // the readers on the cell still find the rest of the list after it
+    atomic_store_explicit(previous, atomic_load_explicit(&cell->nextCell, memory_order_relaxed), memory_order_release);
+    hashtable->numberOfPairs--;
+    cell->nextRetired = hashtable->retiredCells;
+    hashtable->retiredCells = cell;
+    hashtable->nbRetiredCells++;
+    if (hashtable->nbRetiredCells >= CONCURRENT_HASHTABLE_RETIRE_BATCH) {
+        concurrentFreeRetiredCells(hashtable);
+    }
+    pthread_mutex_unlock(&hashtable->writeLock);
+    return 1;
+}
+
+
+/**
+ * Get the value associated with the given key, without any lock.
+ *
+ * @param hashtable the hash table to search in
+ * @param reader the identifier of the calling thread
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int concurrentHashtableGetValue(ConcurrentHashTable *hashtable, int reader, string key) {
+    size_t sizeKey = strlen(key);
+    uint32_t hash = murmurhash32(key, sizeKey);
+    concurrentReaderEnter(hashtable, reader);
+    ConcurrentTable *table = atomic_load_explicit(&hashtable->table, memory_order_acquire);
+    ConcurrentCell *cell = concurrentFindCell(table, key, sizeKey, hash);
+    int value = cell == NULL ? -1 : atomic_load_explicit(&cell->value, memory_order_relaxed);
+    concurrentReaderExit(hashtable, reader);
+    return value;
+}
+
+
+/**
+ * Test if a key is in the hash table, without any lock.
+ *
+ * @param hashtable the hash table to search in
+ * @param reader the identifier of the calling thread
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int concurrentHashtableHasKey(ConcurrentHashTable *hashtable, int reader, string key) {
+    size_t sizeKey = strlen(key);
+    uint32_t hash = murmurhash32(key, sizeKey);
+    concurrentReaderEnter(hashtable, reader);
+    ConcurrentTable *table = atomic_load_explicit(&hashtable->table, memory_order_acquire);
+    int found = concurrentFindCell(table, key, sizeKey, hash) != NULL;
+    concurrentReaderExit(hashtable, reader);
+    return found;
+}
+
+
+/**
+ * Returns the number of pairs stored in the hash table.
+ * @param hashtable the hash table
+ * @return the number of pairs
+ */
+size_t concurrentHashtableNumberOfPairs(ConcurrentHashTable *hashtable) {
+    pthread_mutex_lock(&hashtable->writeLock);
+    size_t numberOfPairs = hashtable->numberOfPairs;
+    pthread_mutex_unlock(&hashtable->writeLock);
+    return numberOfPairs;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file concurrenthashtable.h
+ * @brief Header file for a concurrent hash table whose lookups take no lock
+ *
+ * This file contains the declaration of a hash table made for read-mostly
+ * workloads: any number of threads look keys up without any lock nor any
+ * write to a shared cache line, while writers (serialized by a lock)
+ * insert, update and remove pairs and resize the table.
+ *
+ * The writers never modify a cell that a reader may be traversing, except
+ * its value and its link to the next cell, which are atomic: a new cell is
+ * published by a single atomic store of the head of its list, and a new
+ * table (after a resizing) by a single atomic store of the table pointer.
+ * The cells and the tables that are unlinked cannot be freed at once, since
+ * a reader may still be reading them (RCU style): they are freed after a
+ * grace period, when every reader has finished the lookup it had started.
+ * To know it, each reader has its own slot, on its own cache line, where
+ * it writes the current epoch when it starts a lookup and 0 when it ends it.
+ */
+
+
+#ifndef CONCURRENTHASHTABLE_H_INCLUDED
+#define CONCURRENTHASHTABLE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "hashtable.h"
+
+/**
+ * @brief Maximal number of reader threads registered at the same time
+ */
+#define CONCURRENT_HASHTABLE_MAX_READERS 64
+
+/**
+ * @brief Number of removed cells kept before a grace period frees them
+ */
+#define CONCURRENT_HASHTABLE_RETIRE_BATCH 64
+
+/**
+ * @brief Alignment of the slots of the readers, so that two readers never
+ * share a cache line
+ */
+#define CONCURRENT_HASHTABLE_ALIGNMENT 64
+
+/**
+ * @brief Definition of a cell of a concurrent hash table
+ *
+ * The key, its length and its hash code never change once the cell is
+ * published. The key is stored right after the structure.
+ */
+typedef struct concurrentCell{
+    struct concurrentCell *_Atomic nextCell; /**< Next cell in the list */
+    _Atomic int value; /**< Value of the cell */
+    uint32_t hash; /**< Hash code of the key (murmurhash32) */
+    size_t sizeKey; /**< Length of the key */
+    struct concurrentCell *nextRetired; /**< Next removed cell waiting for a grace period */
+    char key[]; /**< Key, followed by a NUL character */
+} ConcurrentCell;
+
+/**
+ * @brief Definition of a table of lists of a concurrent hash table
+ *
+ * The size of a table is a power of two, and a table is never resized:
+ * a larger table is built and published instead.
+ */
+typedef struct concurrentTable{
+    size_t sizeTable; /**< Number of lists */
+    ConcurrentCell *_Atomic *lists; /**< First cell of each list */
+} ConcurrentTable;
+
+/**
+ * @brief Slot of a reader
+ *
+ * [epoch] is the epoch at which the reader started its current lookup,
+ * 0 when the reader is not in a lookup.
+ */
+typedef struct concurrentReader{
+    _Alignas(CONCURRENT_HASHTABLE_ALIGNMENT) _Atomic uint64_t epoch; /**< Epoch of the current lookup, 0 if none */
+    _Atomic int registered; /**< 1 if the slot is given to a thread */
+} ConcurrentReader;
+
+/**
+ * @brief Definition of a concurrent hash table
+ *
+ * The readers only read [table] and write their own slot of [readers].
+ * The other fields are only used by the writers, which hold [writeLock].
+ * The removed cells wait in [retiredCells] for the next grace period.
+ */
+typedef struct concurrentHashtable{
+    ConcurrentTable *_Atomic table; /**< Current table */
+    ConcurrentReader *readers; /**< Slots of the readers */
+    _Atomic uint64_t epoch; /**< Current epoch, incremented by each grace period */
+    pthread_mutex_t writeLock; /**< Lock of the writers */
+    size_t numberOfPairs; /**< Number of pairs */
+    ConcurrentCell *retiredCells; /**< Removed cells not freed yet */
+    size_t nbRetiredCells; /**< Number of removed cells not freed yet */
+} ConcurrentHashTable;
+
+
+/**
+ * Create a new concurrent hash table.
+ *
+ * @param sizeTable the initial size of the table, rounded up to a power of two
+ * @return a pointer on the empty hash table, to destroy with concurrentHashtableDestroy
+ */
+ConcurrentHashTable *concurrentHashtableCreate(size_t sizeTable);
+
+/**
+ * Free the memory used by the concurrent hash table. No other thread
+ * may use the hash table during and after the call.
+ * @param hashtable hash table to free
+ */
+void concurrentHashtableDestroy(ConcurrentHashTable *hashtable);
+
+/**
+ * Register the calling thread as a reader of the hash table.
+ *
+ * @param hashtable the hash table
+ * @return the identifier of the reader, to give to the lookups of the
+ * thread, -1 if CONCURRENT_HASHTABLE_MAX_READERS readers are already registered
+ */
+int concurrentHashtableRegisterReader(ConcurrentHashTable *hashtable);
+
+/**
+ * Give back the slot of a reader, that will do no more lookups.
+ * @param hashtable the hash table
+ * @param reader the identifier of the reader
+ */
+void concurrentHashtableUnregisterReader(ConcurrentHashTable *hashtable, int reader);
+
+/**
+ * Insert a new key-value pair into the hash table, or replace the value
+ * if the key is already in the hash table. The table doubles its size
+ * when it has as many pairs as lists.
+ *
+ * @param hashtable pointer on the hash table to insert into
+ * @param key the key for the new pair
+ * @param value the value for the new pair
+ */
+void concurrentHashtableInsert(ConcurrentHashTable *hashtable, string key, int value);
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ *
+ * The cell is freed later, after a grace period.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int concurrentHashtableRemove(ConcurrentHashTable *hashtable, string key);
+
+/**
+ * Get the value associated with the given key, without any lock.
+ *
+ * @param hashtable the hash table to search in
+ * @param reader the identifier of the calling thread, given by
+ * concurrentHashtableRegisterReader
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int concurrentHashtableGetValue(ConcurrentHashTable *hashtable, int reader, string key);
+
+/**
+ * Test if a key is in the hash table, without any lock.
+ *
+ * @param hashtable the hash table to search in
+ * @param reader the identifier of the calling thread, given by
+ * concurrentHashtableRegisterReader
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int concurrentHashtableHasKey(ConcurrentHashTable *hashtable, int reader, string key);
+
+/**
+ * Returns the number of pairs stored in the hash table.
+ * @param hashtable the hash table
+ * @return the number of pairs
+ */
+size_t concurrentHashtableNumberOfPairs(ConcurrentHashTable *hashtable);
+
+#endif // CONCURRENTHASHTABLE_H_INCLUDED
@@ -0,0 +1,487 @@
+/**
+ * @file frozenhashtable.c
+ * @brief Source file for a read-only hash table based on a minimal perfect hash
+ *
+ * The keys are hashed once with wyhash64. The high 32 bits of the hash code
+ * select the bucket of the key, and the slot of the key is given by the hash
+ * code mixed with the pilot of its bucket.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "frozenhashtable.h"
+#include "hashfunctions.h"
+#include "hashtable.h"
+
+/**
+ * @brief A pair of the hash table to freeze, with its 64-bit hash code
+ */
+typedef struct frozenEntry{
+    uint64_t hash;
+    Cell *cell;
+} FrozenEntry;
+
+/**
+ * @brief Returns the bucket of a hash code
+ */
+static inline size_t frozenBucket(uint64_t hash, size_t nbBuckets) {
+    return (size_t)(((hash >> 32) * (uint64_t)nbBuckets) >> 32);
+}
+
+/**
+ * @brief Returns the slot of a hash code, for a given pilot of its bucket
+ *
+ * The multiplication by nbSlots keeps the high bits of the mixed hash code,
+ * so that no division is needed.
+ */
+static inline size_t frozenSlot(uint64_t hash, uint32_t pilot, size_t nbSlots) {
+    uint64_t mixed = hash ^ ((uint64_t)pilot * 0x9e3779b97f4a7c15ull);
+    mixed ^= mixed >> 29;
+    mixed *= 0xbf58476d1ce4e5b9ull;
+    mixed ^= mixed >> 32;
+    return (size_t)(((__uint128_t)mixed * nbSlots) >> 64);
+}
+
+/**
+ * @brief Adds the cells of a table of lists to the entries to freeze
+ *
+ * @param table the table of lists
+ * @param sizeTable the size of the table
+ * @param entries array that receives the entries
+ * @param nbEntries pointer on the number of entries already in the array
+ * @param sizeKeys pointer on the total length of the keys, increased
+ */
+static void collectEntries(List *table, size_t sizeTable, FrozenEntry *entries, size_t *nbEntries, size_t *sizeKeys) {
+    for (size_t i = 0; i < sizeTable; i++) {
+        for (Cell *cell = table[i]; cell != NULL; cell = cell->nextCell) {
+            entries[*nbEntries].hash = wyhash64(cell->key, cell->sizeKey);
+            entries[*nbEntries].cell = cell;
+            (*nbEntries)++;
+            *sizeKeys += cell->sizeKey;
+        }
+    }
+}
+
+/**
+ * @brief Finds the pilot of a bucket and gives the slots of its keys
+ *
+ * The pilots are tried in increasing order until all the keys of the bucket
+ * fall into free and distinct slots.
+ *
+ * @param entries the entries of the bucket
+ * @param size the number of entries of the bucket
+ * @param nbSlots the number of slots
+ * @param taken array of nbSlots flags of the slots already taken, updated
+ * @param slots array of at least size elements that receives the slots of the keys
+ * @return the pilot of the bucket
+ */
+static uint32_t findPilot(FrozenEntry *entries, size_t size, size_t nbSlots, uint8_t *taken, size_t *slots) {
+    uint32_t pilot = 0;
+    for (;;) {
+        size_t i = 0;
+        while (i < size) {
+            slots[i] = frozenSlot(entries[i].hash, pilot, nbSlots);
+            if (taken[slots[i]]) {
+                break;
+            }
+            size_t j = 0;
+            while (j < i && slots[j] != slots[i]) {
+                j++;
+            }
+            if (j < i) {
+                break;
+            }
+            i++;
+        }
+        if (i == size) {
+            break;
+        }
+        pilot++;
+    }
+    for (size_t i = 0; i < size; i++) {
+        taken[slots[i]] = 1;
+    }
+    return pilot;
+}
+
+/**
+ * @brief Returns the slot that may contain the key, or -1 if the table is empty
+ */
+static long frozenFindSlot(FrozenHashTable hashtable, string key, size_t sizeKey) {
+    if (hashtable.numberOfPairs == 0) {
+        return -1;
+    }
+    uint64_t hash = wyhash64(key, sizeKey);
+    uint32_t pilot = hashtable.pilots[frozenBucket(hash, hashtable.nbBuckets)];
+    size_t slot = frozenSlot(hash, pilot, hashtable.numberOfPairs);
+    uint32_t offset = hashtable.slots[slot].keyOffset;
+    uint32_t next = hashtable.slots[slot + 1].keyOffset;
+    // the offsets of a mapped snapshot are not checked by the load: a slot
+    // whose key is not inside the keys holds no key
+    if (offset >= next || next > hashtable.sizeKeys) {
+        return -1;
+    }
+    // any key has a slot: the key of the slot must be compared
+    if (next - offset - 1 == sizeKey
+        && memcmp(hashtable.keys + offset, key, sizeKey) == 0) {
+        return (long)slot;
+    }
+    return -1;
+}
+
+
+/**
+ * Create a frozen hash table with the pairs of a hash table.
+ *
+ * @param hashtable the hash table to freeze
+ * @return the frozen hash table, empty if the pairs cannot be frozen
+ */
+FrozenHashTable frozenHashtableCreate(HashTable hashtable) {
+    FrozenHashTable frozen;
+    frozen.numberOfPairs = 0;
+    frozen.nbBuckets = 0;
+    frozen.pilots = NULL;
+    frozen.slots = NULL;
+    frozen.keys = NULL;
+    frozen.sizeKeys = 0;
+    frozen.mapping = NULL;
+    frozen.sizeMapping = 0;
+    size_t n = hashtable.numberOfPairs;
+    if (n == 0) {
+        return frozen;
+    }
+
+    FrozenEntry *entries = (FrozenEntry *)malloc(n * sizeof(FrozenEntry));
+    size_t nbEntries = 0;
+    size_t sizeKeys = 0;
+    collectEntries(hashtable.table, hashtable.sizeTable, entries, &nbEntries, &sizeKeys);
+    if (hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        collectEntries(hashtable.resize->oldTable, hashtable.resize->sizeOldTable, entries, &nbEntries, &sizeKeys);
+    }
+    if (sizeKeys + n >= UINT32_MAX) {
+        printf("Error:keys too long to be frozen\n");
+        free(entries);
+        return frozen;
+    }
+
+    // entries sorted by bucket (counting sort)
+    size_t nbBuckets = (n + FROZEN_KEYS_PER_BUCKET - 1) / FROZEN_KEYS_PER_BUCKET;
+    size_t *bucketStarts = (size_t *)calloc(nbBuckets + 1, sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        bucketStarts[frozenBucket(entries[i].hash, nbBuckets) + 1]++;
+    }
+    size_t maxSize = 0;
+    for (size_t b = 0; b < nbBuckets; b++) {
+        if (bucketStarts[b + 1] > maxSize) {
+            maxSize = bucketStarts[b + 1];
+        }
+        bucketStarts[b + 1] += bucketStarts[b];
+    }
+    FrozenEntry *sorted = (FrozenEntry *)malloc(n * sizeof(FrozenEntry));
+    size_t *next = (size_t *)malloc(nbBuckets * sizeof(size_t));
+    memcpy(next, bucketStarts, nbBuckets * sizeof(size_t));
+    for (size_t i = 0; i < n; i++) {
+        sorted[next[frozenBucket(entries[i].hash, nbBuckets)]++] = entries[i];
+    }
+    free(entries);
+
+    // buckets sorted by decreasing size (counting sort), the largest
+    // buckets being placed while most of the slots are still free
+    size_t *sizeStarts = (size_t *)calloc(maxSize + 2, sizeof(size_t));
+    for (size_t b = 0; b < nbBuckets; b++) {
+        sizeStarts[maxSize - (bucketStarts[b + 1] - bucketStarts[b]) + 1]++;
+    }
+    for (size_t s = 0; s <= maxSize; s++) {
+        sizeStarts[s + 1] += sizeStarts[s];
+    }
+    size_t *order = next;
+    for (size_t b = 0; b < nbBuckets; b++) {
+        order[sizeStarts[maxSize - (bucketStarts[b + 1] - bucketStarts[b])]++] = b;
+    }
+    free(sizeStarts);
+
+    uint32_t *pilots = (uint32_t *)calloc(nbBuckets, sizeof(uint32_t));
+    uint8_t *taken = (uint8_t *)calloc(n, sizeof(uint8_t));
+    size_t *bucketSlots = (size_t *)malloc(maxSize * sizeof(size_t));
+    Cell **slotCells = (Cell **)malloc(nbEntries * sizeof(Cell *));
+    int error = 0;
+    for (size_t k = 0; k < nbBuckets && !error; k++) {
+        size_t b = order[k];
+        FrozenEntry *bucket = sorted + bucketStarts[b];
+        size_t size = bucketStarts[b + 1] - bucketStarts[b];
+        if (size == 0) {
+            break;
+        }
+        // two keys with the same hash code never get distinct slots
+        for (size_t i = 0; i < size && !error; i++) {
+            for (size_t j = 0; j < i; j++) {
+                if (bucket[i].hash == bucket[j].hash) {
+                    error = 1;
+                    break;
+                }
+            }
+        }
+        if (error) {
+            break;
+        }
+        pilots[b] = findPilot(bucket, size, n, taken, bucketSlots);
+        for (size_t i = 0; i < size; i++) {
+            slotCells[bucketSlots[i]] = bucket[i].cell;
+        }
+    }
+    free(bucketSlots);
+    free(taken);
+    free(order);
+    free(sorted);
+    free(bucketStarts);
+    if (error) {
+        printf("Error:two keys with the same hash code\n");
+        free(pilots);
+        free(slotCells);
+        return frozen;
+    }
+
+    // keys and values packed in the order of the slots
+    frozen.numberOfPairs = n;
+    frozen.nbBuckets = nbBuckets;
+    frozen.pilots = pilots;
+    frozen.slots = (FrozenSlot *)malloc((n + 1) * sizeof(FrozenSlot));
+    frozen.keys = (char *)malloc(sizeKeys + n);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < n; i++) {
+        Cell *cell = slotCells[i];
+        frozen.slots[i].keyOffset = offset;
+        frozen.slots[i].value = cell->value;
+        memcpy(frozen.keys + offset, cell->key, cell->sizeKey);
+        frozen.keys[offset + cell->sizeKey] = '\0';
+        offset += cell->sizeKey + 1;
+    }
+    frozen.slots[n].keyOffset = offset;
+    frozen.slots[n].value = -1;
+    frozen.sizeKeys = offset;
+    free(slotCells);
+    return frozen;
+}
+
+
+/**
+ * Free the memory used by the frozen hash table.
+ * @param hashtable hash table to free
+ */
+void frozenHashtableDestroy(FrozenHashTable *hashtable) {
+    if (hashtable->mapping != NULL) {
+        munmap(hashtable->mapping, hashtable->sizeMapping);
+    }
+    else {
+        free(hashtable->pilots);
+        free(hashtable->slots);
+        free(hashtable->keys);
+    }
+    hashtable->mapping = NULL;
+    hashtable->sizeMapping = 0;
+    hashtable->numberOfPairs = 0;
+    hashtable->nbBuckets = 0;
+    hashtable->pilots = NULL;
+    hashtable->slots = NULL;
+    hashtable->keys = NULL;
+    hashtable->sizeKeys = 0;
+}
+
+
+/**
+ * Test if a key is in the frozen hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int frozenHashtableHasKey(FrozenHashTable hashtable, string key) {
+    return frozenHashtableHasKeyLen(hashtable, key, strlen(key));
+}
+
+
+/**
+ * Same as frozenHashtableHasKey, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int frozenHashtableHasKeyLen(FrozenHashTable hashtable, string key, size_t sizeKey) {
+    if (frozenFindSlot(hashtable, key, sizeKey) >= 0) {
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int frozenHashtableGetValue(FrozenHashTable hashtable, string key) {
+    return frozenHashtableGetValueLen(hashtable, key, strlen(key));
+}
+
+
+/**
+ * Same as frozenHashtableGetValue, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int frozenHashtableGetValueLen(FrozenHashTable hashtable, string key, size_t sizeKey) {
+    long slot = frozenFindSlot(hashtable, key, sizeKey);
+    if (slot >= 0) {
+        return hashtable.slots[slot].value;
+    }
+    return -1;
+}
+
+
+/**
+ * Save a frozen hash table in a snapshot file.
+ *
+ * @param hashtable the hash table to save
+ * @param fileName name of the snapshot file, replaced if it exists
+ * @return 1 if the file is written, 0 otherwise
+ */
+int frozenHashtableSave(FrozenHashTable hashtable, string fileName) {
+    FrozenSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FROZEN_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = FROZEN_SNAPSHOT_VERSION;
+    header.byteOrder = 0x01020304;
+    header.numberOfPairs = hashtable.numberOfPairs;
+    header.nbBuckets = hashtable.nbBuckets;
+    header.sizeKeys = hashtable.sizeKeys;
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) {
+        printf("Error:cannot write %s\n", fileName);
+        return 0;
+    }
+    int written = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (written && hashtable.numberOfPairs > 0) {
+        written = fwrite(hashtable.pilots, sizeof(uint32_t), hashtable.nbBuckets, file) == hashtable.nbBuckets
+            && fwrite(hashtable.slots, sizeof(FrozenSlot), hashtable.numberOfPairs + 1, file) == hashtable.numberOfPairs + 1
+            && fwrite(hashtable.keys, 1, header.sizeKeys, file) == header.sizeKeys;
+    }
+    if (fclose(file) != 0 || !written) {
+        printf("Error:cannot write %s\n", fileName);
+        return 0;
+    }
+    return 1;
+}
+
+
+/**
+ * @brief Checks the header of a snapshot, in constant time
+ *
+ * The sizes of the header must not overflow and must give the size of the
+ * file, so that the pilots, the slots and the keys are inside the mapping.
+ * The offsets of the keys are checked by the lookups.
+ *
+ * @param header the header, at the start of the mapping
+ * @param sizeMapping the size of the file
+ * @return 1 if the snapshot is valid, 0 otherwise
+ */
+static int frozenSnapshotIsValid(const FrozenSnapshotHeader *header, size_t sizeMapping) {
+    if (memcmp(header->magic, FROZEN_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+        || header->version != FROZEN_SNAPSHOT_VERSION || header->byteOrder != 0x01020304) {
+        return 0;
+    }
+    uint64_t n = header->numberOfPairs;
+    if (n == 0) {
+        return sizeMapping == sizeof(FrozenSnapshotHeader);
+    }
+    uint64_t sizePilots, sizeSlots, expectedSize;
+    if (header->nbBuckets == 0 || header->sizeKeys > UINT32_MAX
+        || __builtin_mul_overflow(header->nbBuckets, sizeof(uint32_t), &sizePilots)
+        || __builtin_add_overflow(n, 1, &sizeSlots)
+        || __builtin_mul_overflow(sizeSlots, sizeof(FrozenSlot), &sizeSlots)
+        || __builtin_add_overflow(sizeof(FrozenSnapshotHeader), sizePilots, &expectedSize)
+        || __builtin_add_overflow(expectedSize, sizeSlots, &expectedSize)
+        || __builtin_add_overflow(expectedSize, header->sizeKeys, &expectedSize)
+        || expectedSize != sizeMapping) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Load a frozen hash table from a snapshot file.
+ *
+ * @param fileName name of the snapshot file
+ * @return the frozen hash table, empty if the file cannot be loaded
+ */
+FrozenHashTable frozenHashtableLoad(string fileName) {
+    FrozenHashTable hashtable;
+    hashtable.numberOfPairs = 0;
+    hashtable.nbBuckets = 0;
+    hashtable.pilots = NULL;
+    hashtable.slots = NULL;
+    hashtable.keys = NULL;
+    hashtable.sizeKeys = 0;
+    hashtable.mapping = NULL;
+    hashtable.sizeMapping = 0;
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) {
+        printf("Error:file not found\n");
+        return hashtable;
+    }
+    struct stat fileStatus;
+    void *mapping = MAP_FAILED;
+    if (fstat(file, &fileStatus) == 0 && (size_t)fileStatus.st_size >= sizeof(FrozenSnapshotHeader)) {
+        mapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (mapping == MAP_FAILED) {
+        printf("Error:%s is not a snapshot\n", fileName);
+        return hashtable;
+    }
+    size_t sizeMapping = (size_t)fileStatus.st_size;
+    const FrozenSnapshotHeader *header = (const FrozenSnapshotHeader *)mapping;
+    size_t n = header->numberOfPairs;
+    if (!frozenSnapshotIsValid(header, sizeMapping)) {
+        printf("Error:%s is not a snapshot\n", fileName);
+        munmap(mapping, sizeMapping);
+        return hashtable;
+    }
+    // the lookups touch the pages in a random order
+    madvise(mapping, sizeMapping, MADV_RANDOM);
+    char *data = (char *)mapping + sizeof(FrozenSnapshotHeader);
+    hashtable.numberOfPairs = n;
+    hashtable.nbBuckets = header->nbBuckets;
+    hashtable.pilots = (uint32_t *)data;
+    hashtable.slots = (FrozenSlot *)(data + header->nbBuckets * sizeof(uint32_t));
+    hashtable.keys = (char *)(hashtable.slots + n + 1);
+    hashtable.sizeKeys = header->sizeKeys;
+    hashtable.mapping = mapping;
+    hashtable.sizeMapping = sizeMapping;
+    return hashtable;
+}
+
+
+/**
+ * Returns the number of bytes used by the frozen hash table.
+ * @param hashtable the hash table
+ * @return the number of bytes of the pilots, the keys and the values
+ */
+size_t frozenHashtableBytes(FrozenHashTable hashtable) {
+    if (hashtable.numberOfPairs == 0) {
+        return 0;
+    }
+    return hashtable.nbBuckets * sizeof(uint32_t)
+        + (hashtable.numberOfPairs + 1) * sizeof(FrozenSlot)
+        + hashtable.sizeKeys;
+}
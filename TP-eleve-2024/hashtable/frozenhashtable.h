@@ -0,0 +1,183 @@
+/**
+ * @file frozenhashtable.h
+ * @brief Header file for a read-only hash table based on a minimal perfect hash
+ *
+ * This file contains the declaration of a frozen hash table: a copy of
+ * a HashTable that can no longer be modified, where each of the n keys
+ * has its own slot among n slots (minimal perfect hashing, in the style
+ * of CHD: hash and displace). The keys are spread into small buckets, and
+ * each bucket stores a pilot, chosen when the table is frozen so that the
+ * keys of all the buckets fall into distinct slots.
+ * A lookup computes the hash code of the key, reads the pilot of its
+ * bucket and compares the key with the only slot where it can be.
+ *
+ * A frozen hash table can be saved in a snapshot file, whose layout is the
+ * layout of the table in memory. Loading the snapshot maps the file in
+ * memory: the lookups read the pilots, the slots and the keys directly in
+ * the mapped pages, which are read from the disk when they are first used.
+ */
+
+
+#ifndef FROZENHASHTABLE_H_INCLUDED
+#define FROZENHASHTABLE_H_INCLUDED
+
+#include <stdint.h>
+#include "hashtable.h"
+
+/**
+ * @brief Average number of keys per bucket of pilots
+ */
+#define FROZEN_KEYS_PER_BUCKET 4
+
+/**
+ * @brief Magic bytes at the beginning of a snapshot file
+ */
+#define FROZEN_SNAPSHOT_MAGIC "FROZENHT"
+
+/**
+ * @brief Version of the layout of the snapshot files
+ */
+#define FROZEN_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Header of a snapshot file
+ *
+ * The header is followed by the pilots, the slots (with the last element
+ * giving the end of the keys) and the packed keys. The numbers are written
+ * in the byte order of the machine, checked with [byteOrder].
+ */
+typedef struct frozenSnapshotHeader{
+    char magic[8]; /**< FROZEN_SNAPSHOT_MAGIC, without '\0' */
+    uint32_t version; /**< FROZEN_SNAPSHOT_VERSION */
+    uint32_t byteOrder; /**< 0x01020304 */
+    uint64_t numberOfPairs; /**< Number of pairs (and of slots) */
+    uint64_t nbBuckets; /**< Number of pilots */
+    uint64_t sizeKeys; /**< Number of bytes of the packed keys */
+} FrozenSnapshotHeader;
+
+/**
+ * @brief Definition of a slot of a frozen hash table
+ *
+ * The offset of the key and the value are side by side, so that a lookup
+ * reads them in the same cache line.
+ */
+typedef struct frozenSlot{
+    uint32_t keyOffset; /**< Offset of the key of the slot in the packed keys */
+    int value; /**< Value of the slot */
+} FrozenSlot;
+
+/**
+ * @brief Definition of a frozen hash table
+ *
+ * The structure contains the number of pairs [numberOfPairs], which is
+ * also the number of slots, and the pilots [pilots] of the [nbBuckets]
+ * buckets. The keys of the slots are packed one after the other, each
+ * followed by '\0', in [keys]: the key of the slot i starts at
+ * slots[i].keyOffset and ends before slots[i+1].keyOffset-1, the array
+ * [slots] having a last element that only gives the end of the keys.
+ * The field [sizeKeys] is the number of bytes of [keys].
+ * The field [mapping] is NULL when the arrays are allocated, otherwise
+ * it is the mapped snapshot file of size [sizeMapping] that contains them.
+ */
+typedef struct frozenHashtable{
+    size_t numberOfPairs;
+    size_t nbBuckets;
+    uint32_t *pilots;
+    FrozenSlot *slots;
+    char *keys;
+    size_t sizeKeys;
+    void *mapping;
+    size_t sizeMapping;
+} FrozenHashTable;
+
+
+/**
+ * Create a frozen hash table with the pairs of a hash table.
+ *
+ * The pilots are searched bucket after bucket, the largest buckets first,
+ * which takes a time close to linear in the number of pairs. The input
+ * hash table is not modified and can be destroyed afterwards.
+ *
+ * @param hashtable the hash table to freeze
+ * @return the frozen hash table, empty if the pairs cannot be frozen
+ * (keys longer than 4 GB in total, or two keys with the same 64-bit hash code)
+ */
+FrozenHashTable frozenHashtableCreate(HashTable hashtable);
+
+/**
+ * Free the memory used by the frozen hash table, or unmap its
+ * snapshot file if it has been loaded with frozenHashtableLoad.
+ * @param hashtable hash table to free
+ */
+void frozenHashtableDestroy(FrozenHashTable *hashtable);
+
+/**
+ * Test if a key is in the frozen hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int frozenHashtableHasKey(FrozenHashTable hashtable, string key);
+
+/**
+ * Same as frozenHashtableHasKey, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int frozenHashtableHasKeyLen(FrozenHashTable hashtable, string key, size_t sizeKey);
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int frozenHashtableGetValue(FrozenHashTable hashtable, string key);
+
+/**
+ * Same as frozenHashtableGetValue, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int frozenHashtableGetValueLen(FrozenHashTable hashtable, string key, size_t sizeKey);
+
+/**
+ * Save a frozen hash table in a snapshot file. A HashTable is saved
+ * by saving the frozen hash table created with its pairs.
+ *
+ * @param hashtable the hash table to save
+ * @param fileName name of the snapshot file, replaced if it exists
+ * @return 1 if the file is written, 0 otherwise
+ */
+int frozenHashtableSave(FrozenHashTable hashtable, string fileName);
+
+/**
+ * Load a frozen hash table from a snapshot file.
+ *
+ * The file is mapped in memory and nothing is read nor copied: the
+ * lookups read the mapped pages, so that the load time does not depend
+ * on the number of pairs. Only the header and the size of the file are
+ * checked, the file is supposed to have been written by frozenHashtableSave.
+ * A lookup checks the offsets of the only slot it reads, so that a
+ * corrupted file never makes it read outside the keys.
+ *
+ * @param fileName name of the snapshot file
+ * @return the frozen hash table, empty if the file cannot be loaded
+ *
+ * The hash table must be destroyed by frozenHashtableDestroy, which
+ * unmaps the file.
+ */
+FrozenHashTable frozenHashtableLoad(string fileName);
+
+/**
+ * Returns the number of bytes used by the frozen hash table.
+ * @param hashtable the hash table
+ * @return the number of bytes of the pilots, the keys and the values
+ */
+size_t frozenHashtableBytes(FrozenHashTable hashtable);
+
+#endif // FROZENHASHTABLE_H_INCLUDED
@@ -0,0 +1,321 @@
+/**
+ * @file hashfunctions.c
+ * @brief Source file for 64-bit hash functions that can replace murmurhash
+ *
+ * The words of the keys are read with memcpy, which the compiler turns
+ * into a single unaligned load instead of a cast of the key pointer.
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+/**
+ * @brief Defined when an AVX2 version can be compiled and chosen at run time
+ */
+#define STRIPE_HASH_AVX2
+#endif
+
+#include "hashfunctions.h"
+#include "hashtable.h"
+
+/**
+ * @brief Number of 64-bit lanes of a stripe in stripeHash64
+ */
+#define STRIPE_LANES 8
+
+/**
+ * @brief Number of stripes between two scramblings of the lanes
+ */
+#define STRIPES_PER_BLOCK 16
+
+/**
+ * @brief Odd 32-bit constant used to scramble the lanes
+ */
+#define STRIPE_PRIME 0x9e3779b1u
+
+/**
+ * @brief Constants of wyhash64
+ */
+static const uint64_t wySecret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+/**
+ * @brief Constants xored with the lanes of a stripe, then with the lanes
+ * when they are scrambled
+ */
+static const uint64_t stripeSecret[2 * STRIPE_LANES] = {
+    0x9f6d8fecf88eecd5ull, 0x18e430bb1511f2d3ull, 0x4c6f7cbf58dba57full, 0x1dbe69e0ae9bb859ull,
+    0xd4a0c1656476437bull, 0x8d6b7b6d69455aebull, 0x230249cae3603297ull, 0x98aa033e99c4a793ull,
+    0x2b39e8e05ba9e531ull, 0x6d467b84dc360331ull, 0x762887bf5d21a339ull, 0xd644a39996a5cd1bull,
+    0xd811dfdb557fab8bull, 0xa955c3c7d9d3af85ull, 0x25430e1349d55355ull, 0xb05386bf060a34c7ull
+};
+
+/**
+ * @brief Multiplies a and b and folds the 128-bit product on 64 bits
+ */
+static inline uint64_t mix64(uint64_t a, uint64_t b) {
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+/**
+ * @brief Reads 8 bytes of a key
+ */
+static inline uint64_t read64(const uint8_t *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Reads 4 bytes of a key
+ */
+static inline uint64_t read32(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+/**
+ * @brief Hash function in the style of wyhash
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t wyhash64(string key, size_t sizeKey) {
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t seed = mix64(wySecret[0], wySecret[1]);
+    uint64_t a, b;
+    if (sizeKey <= 16) {
+        if (sizeKey >= 4) {
+            // two overlapping reads of 4 bytes at each end cover the key
+            size_t middle = (sizeKey >> 3) << 2;
+            a = (read32(p) << 32) | read32(p + middle);
+            b = (read32(p + sizeKey - 4) << 32) | read32(p + sizeKey - 4 - middle);
+        }
+        else if (sizeKey > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[sizeKey >> 1] << 8) | p[sizeKey - 1];
+            b = 0;
+        }
+        else {
+            a = 0;
+            b = 0;
+        }
+    }
+    else {
+        size_t remaining = sizeKey;
+        if (remaining > 48) {
+            // three independent chains of multiplications
+            uint64_t seed1 = seed, seed2 = seed;
+            do {
+                seed = mix64(read64(p) ^ wySecret[1], read64(p + 8) ^ seed);
+                seed1 = mix64(read64(p + 16) ^ wySecret[2], read64(p + 24) ^ seed1);
+                seed2 = mix64(read64(p + 32) ^ wySecret[3], read64(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        while (remaining > 16) {
+            seed = mix64(read64(p) ^ wySecret[1], read64(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+        a = read64(p + remaining - 16);
+        b = read64(p + remaining - 8);
+    }
+    __uint128_t product = (__uint128_t)(a ^ wySecret[1]) * (b ^ seed);
+    a = (uint64_t)product;
+    b = (uint64_t)(product >> 64);
+    return mix64(a ^ wySecret[0] ^ sizeKey, b ^ wySecret[1]);
+}
+
+
+/**
+ * @brief Accumulates a stripe of 64 bytes in the lanes, without SSE2
+ *
+ * Each lane receives the product of the two halves of its word xored with
+ * the secret, and the word of its neighbour lane.
+ */
+static void accumulateStripeScalar(uint64_t *lanes, const uint8_t *stripe) {
+    for (int j = 0; j < STRIPE_LANES; j++) {
+        uint64_t data = read64(stripe + 8 * j);
+        uint64_t keyed = data ^ stripeSecret[j];
+        lanes[j ^ 1] += data;
+        lanes[j] += (keyed & 0xffffffffu) * (keyed >> 32);
+    }
+}
+
+/**
+ * @brief Scrambles the lanes at the end of a block of stripes, without SSE2
+ */
+static void scrambleLanesScalar(uint64_t *lanes) {
+    for (int j = 0; j < STRIPE_LANES; j++) {
+        uint64_t lane = lanes[j];
+        lane ^= lane >> 47;
+        lane ^= stripeSecret[STRIPE_LANES + j];
+        lanes[j] = lane * STRIPE_PRIME;
+    }
+}
+
+/**
+ * @brief Accumulates stripes of 64 bytes in the lanes, without SIMD instructions
+ */
+static void accumulateStripesScalar(uint64_t *lanes, const uint8_t *p, size_t nbStripes) {
+    for (size_t s = 0; s < nbStripes; s++) {
+        accumulateStripeScalar(lanes, p + 64 * s);
+        if (s % STRIPES_PER_BLOCK == STRIPES_PER_BLOCK - 1) {
+            scrambleLanesScalar(lanes);
+        }
+    }
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Accumulates stripes of 64 bytes in the lanes, two lanes per instruction
+ *
+ * The shuffles and the 32x32->64-bit multiplications work in the same way
+ * on each pair of lanes as accumulateStripeScalar and scrambleLanesScalar.
+ */
+static void accumulateStripesSSE2(uint64_t *lanes, const uint8_t *p, size_t nbStripes) {
+    __m128i vectorLanes[STRIPE_LANES / 2];
+    const __m128i prime = _mm_set1_epi32((int)STRIPE_PRIME);
+    memcpy(vectorLanes, lanes, sizeof(vectorLanes));
+    for (size_t s = 0; s < nbStripes; s++) {
+        for (int j = 0; j < STRIPE_LANES / 2; j++) {
+            __m128i data = _mm_loadu_si128((const __m128i *)(p + 64 * s + 16 * j));
+            __m128i keyed = _mm_xor_si128(data, _mm_loadu_si128((const __m128i *)(stripeSecret + 2 * j)));
+            // the high half of each word in front of its low half
+            __m128i high = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m128i product = _mm_mul_epu32(keyed, high);
+            // the two words swapped, for the neighbour lanes
+            __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            vectorLanes[j] = _mm_add_epi64(vectorLanes[j], _mm_add_epi64(product, swapped));
+        }
+        if (s % STRIPES_PER_BLOCK == STRIPES_PER_BLOCK - 1) {
+            for (int j = 0; j < STRIPE_LANES / 2; j++) {
+                __m128i lane = vectorLanes[j];
+                lane = _mm_xor_si128(lane, _mm_srli_epi64(lane, 47));
+                lane = _mm_xor_si128(lane, _mm_loadu_si128((const __m128i *)(stripeSecret + STRIPE_LANES + 2 * j)));
+                // 64x32-bit multiplication from two 32x32->64-bit multiplications
+                __m128i low = _mm_mul_epu32(lane, prime);
+                __m128i high = _mm_mul_epu32(_mm_srli_epi64(lane, 32), prime);
+                vectorLanes[j] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+            }
+        }
+    }
+    memcpy(lanes, vectorLanes, sizeof(vectorLanes));
+}
+#endif
+
+#ifdef STRIPE_HASH_AVX2
+/**
+ * @brief Accumulates stripes of 64 bytes in the lanes, four lanes per instruction
+ *
+ * Same computation as accumulateStripesSSE2 on vectors of 256 bits. The
+ * function is compiled for AVX2 and only called when the processor has it.
+ */
+__attribute__((target("avx2")))
+static void accumulateStripesAVX2(uint64_t *lanes, const uint8_t *p, size_t nbStripes) {
+    __m256i vectorLanes[STRIPE_LANES / 4];
+    const __m256i prime = _mm256_set1_epi32((int)STRIPE_PRIME);
+    memcpy(vectorLanes, lanes, sizeof(vectorLanes));
+    for (size_t s = 0; s < nbStripes; s++) {
+        for (int j = 0; j < STRIPE_LANES / 4; j++) {
+            __m256i data = _mm256_loadu_si256((const __m256i *)(p + 64 * s + 32 * j));
+            __m256i keyed = _mm256_xor_si256(data, _mm256_loadu_si256((const __m256i *)(stripeSecret + 4 * j)));
+            __m256i high = _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+            __m256i product = _mm256_mul_epu32(keyed, high);
+            __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+            vectorLanes[j] = _mm256_add_epi64(vectorLanes[j], _mm256_add_epi64(product, swapped));
+        }
+        if (s % STRIPES_PER_BLOCK == STRIPES_PER_BLOCK - 1) {
+            for (int j = 0; j < STRIPE_LANES / 4; j++) {
+                __m256i lane = vectorLanes[j];
+                lane = _mm256_xor_si256(lane, _mm256_srli_epi64(lane, 47));
+                lane = _mm256_xor_si256(lane, _mm256_loadu_si256((const __m256i *)(stripeSecret + STRIPE_LANES + 4 * j)));
+                __m256i low = _mm256_mul_epu32(lane, prime);
+                __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(lane, 32), prime);
+                vectorLanes[j] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+            }
+        }
+    }
+    memcpy(lanes, vectorLanes, sizeof(vectorLanes));
+}
+#endif
+
+/**
+ * @brief Hashes a key of at least STRIPE_HASH_MIN_SIZE bytes by stripes
+ *
+ * @param p the key
+ * @param sizeKey length of the key
+ * @param vectorized 1 to use AVX2 or SSE2 when they are available, 0 otherwise
+ * @return the 64-bit hash code of the key
+ */
+static uint64_t stripeHashLong(const uint8_t *p, size_t sizeKey, int vectorized) {
+    uint64_t lanes[STRIPE_LANES];
+    memcpy(lanes, stripeSecret + STRIPE_LANES, sizeof(lanes));
+    size_t nbStripes = sizeKey / 64;
+    if (!vectorized) {
+        accumulateStripesScalar(lanes, p, nbStripes);
+    }
+#ifdef STRIPE_HASH_AVX2
+    else if (__builtin_cpu_supports("avx2")) {
+        accumulateStripesAVX2(lanes, p, nbStripes);
+    }
+#endif
+    else {
+#ifdef __SSE2__
+        accumulateStripesSSE2(lanes, p, nbStripes);
+#else
+        accumulateStripesScalar(lanes, p, nbStripes);
+#endif
+    }
+    // the last 64 bytes, which may overlap the last stripe, end the key
+    uint64_t hash = sizeKey * wySecret[0] ^ wyhash64((string)(p + sizeKey - 64), 64);
+    for (int j = 0; j < STRIPE_LANES; j += 2) {
+        hash += mix64(lanes[j] ^ wySecret[1], lanes[j + 1] ^ wySecret[2]);
+    }
+    hash ^= hash >> 37;
+    hash *= 0x165667919e3779f9ull;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+
+/**
+ * @brief Hash function in the style of xxh3, for long keys
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t stripeHash64(string key, size_t sizeKey) {
+    if (sizeKey < STRIPE_HASH_MIN_SIZE) {
+        return wyhash64(key, sizeKey);
+    }
+    return stripeHashLong((const uint8_t *)key, sizeKey, 1);
+}
+
+
+/**
+ * @brief Scalar version of stripeHash64
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t stripeHash64Scalar(string key, size_t sizeKey) {
+    if (sizeKey < STRIPE_HASH_MIN_SIZE) {
+        return wyhash64(key, sizeKey);
+    }
+    return stripeHashLong((const uint8_t *)key, sizeKey, 0);
+}
@@ -0,0 +1,62 @@
+/**
+ * @file hashfunctions.h
+ * @brief Header file for 64-bit hash functions that can replace murmurhash
+ *
+ * This file contains the declaration of hash functions with the type
+ * HashFunction, that can be given to hashtableCreateWithHash. They read
+ * the keys 8 bytes at a time and never reduce the hash code with a
+ * modulo: the hash table keeps the low bits of the hash code.
+ */
+
+
+#ifndef HASHFUNCTIONS_H_INCLUDED
+#define HASHFUNCTIONS_H_INCLUDED
+
+#include <stdint.h>
+#include "hashtable.h"
+
+/**
+ * @brief Minimal length of the keys hashed by stripes in stripeHash64
+ */
+#define STRIPE_HASH_MIN_SIZE 256
+
+/**
+ * @brief Hash function in the style of wyhash
+ *
+ * The key is read by words of 8 bytes (at most three reads for the keys
+ * of at most 16 bytes) and the words are mixed with 64x64->128-bit
+ * multiplications. It is the fastest function on short keys.
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t wyhash64(string key, size_t sizeKey);
+
+/**
+ * @brief Hash function in the style of xxh3, for long keys
+ *
+ * The keys shorter than STRIPE_HASH_MIN_SIZE are hashed by wyhash64.
+ * The longer keys are cut into stripes of 64 bytes accumulated in
+ * 8 independent lanes, with AVX2 or SSE2 instructions when the processor
+ * has them, so that several words of the key are processed at each cycle.
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t stripeHash64(string key, size_t sizeKey);
+
+/**
+ * @brief Scalar version of stripeHash64
+ *
+ * Gives the same hash codes as stripeHash64 without SIMD instructions, to check
+ * the vectorized version and to measure its speed-up.
+ *
+ * @param key string representing the key to hash, not necessarily NUL-terminated
+ * @param sizeKey length of the key
+ * @return the 64-bit hash code of the key
+ */
+uint64_t stripeHash64Scalar(string key, size_t sizeKey);
+
+#endif // HASHFUNCTIONS_H_INCLUDED
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
 
 #include "hashtable.h"
 #include "../list/list.h"
@@ -23,16 +24,14 @@
  */
 #define ROTL32(x,y)    ((x << y) | (x >> (32 - y)))
 
- /**
- * @brief Hash function murmurhash
+/**
+ * @brief Hash function murmurhash, full 32-bit version
  *
  * @param key string representing the key to hash
  * @param sizeKey length of the string key
- * @param maxValue maximum value (excluded) that must return the hash function
- * @return the hash code of the key between 0 and maxValue-1
+ * @return the 32-bit hash code of the key
  */
-
-size_t murmurhash(string key, size_t sizeKey, size_t maxValue)
+uint32_t murmurhash32(string key, size_t sizeKey)
 {
     const uint32_t c1 = 0xcc9e2d51;
     const uint32_t c2 = 0x1b873593;
@@ -44,7 +43,8 @@ size_t murmurhash(string key, size_t sizeKey, size_t maxValue)
     uint32_t k = 0;
 
     for (size_t i = 0; i < sizeKey / 4; i++) {
-        k = ((uint32_t *)key)[i];
+        // memcpy is a single load, without assuming that the key is aligned
+        memcpy(&k, key + 4 * i, sizeof(k));
         k *= c1;
         k = ROTL32(k, r1);
         k *= c2;
@@ -78,7 +78,501 @@ size_t murmurhash(string key, size_t sizeKey, size_t maxValue)
     hash *= 0xc2b2ae35;
     hash ^= hash >> 16;
 
-    return hash % maxValue;
+    return hash;
+}
+
+ /**
+ * @brief Hash function murmurhash
+ *
+ * @param key string representing the key to hash
+ * @param sizeKey length of the string key
+ * @param maxValue maximum value (excluded) that must return the hash function
+ * @return the hash code of the key between 0 and maxValue-1
+ */
+size_t murmurhash(string key, size_t sizeKey, size_t maxValue)
+{
+    return murmurhash32(key, sizeKey) % maxValue;
+}
+
+
+/**
+ * @brief Returns the bucket of a hash code in a table of the given size
+ *
+ * The division is replaced by a mask when the size is a power of two.
+ */
+static inline size_t hashtableIndex(uint32_t hash, size_t sizeTable) {
+    if ((sizeTable & (sizeTable - 1)) == 0) {
+        return hash & (sizeTable - 1);
+    }
+    return hash % sizeTable;
+}
+
+/**
+ * @brief Returns the hash code of a key with the hash function of the table
+ */
+static inline uint32_t hashtableHash(HashTable hashtable, string key, size_t sizeKey) {
+    if (hashtable.hashFunction == NULL) {
+        return murmurhash32(key, sizeKey);
+    }
+    return (uint32_t)hashtable.hashFunction(key, sizeKey);
+}
+
+/**
+ * Returns the hash code of a key with the hash function of a hash table,
+ * to give to the ...Hash functions when the caller also needs it.
+ *
+ * @param hashtable the hash table
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the hash code of the key
+ */
+uint32_t hashtableHashKey(HashTable hashtable, string key, size_t sizeKey) {
+    return hashtableHash(hashtable, key, sizeKey);
+}
+
+/**
+ * @brief Number of 64-bit words of a block of a Bloom filter (a cache line)
+ */
+#define BLOOM_BLOCK_WORDS 8
+
+/**
+ * @brief Allocates an empty Bloom filter for a table of the given size
+ */
+static HashTableBloom *bloomCreate(size_t sizeTable) {
+    HashTableBloom *bloom = (HashTableBloom *)malloc(sizeof(HashTableBloom));
+    bloom->nbBlocks = (sizeTable * HASHTABLE_BLOOM_BITS_PER_BUCKET + 511) / 512;
+    if (bloom->nbBlocks == 0) {
+        bloom->nbBlocks = 1;
+    }
+    size_t sizeBlocks = bloom->nbBlocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+    bloom->blocks = (uint64_t *)aligned_alloc(BLOOM_BLOCK_WORDS * sizeof(uint64_t), sizeBlocks);
+    memset(bloom->blocks, 0, sizeBlocks);
+    bloom->nbKeys = 0;
+    bloom->next = NULL;
+    return bloom;
+}
+
+/**
+ * @brief Frees a Bloom filter and the filter being built, if any
+ */
+static void bloomFree(HashTableBloom *bloom) {
+    if (bloom == NULL) {
+        return;
+    }
+    bloomFree(bloom->next);
+    free(bloom->blocks);
+    free(bloom);
+}
+
+/**
+ * @brief Returns the block of a hash code, selected by its high bits
+ */
+static inline uint64_t *bloomBlock(HashTableBloom *bloom, uint32_t hash) {
+    return bloom->blocks + BLOOM_BLOCK_WORDS * (((uint64_t)hash * bloom->nbBlocks) >> 32);
+}
+
+/**
+ * @brief Returns the mixed hash code whose groups of 9 bits give the
+ * positions of the bits of a key in its block
+ */
+static inline uint64_t bloomPositions(uint32_t hash) {
+    uint64_t positions = hash * 0x9e3779b97f4a7c15ull;
+    positions ^= positions >> 32;
+    positions *= 0xd6e8feb86659fd93ull;
+    positions ^= positions >> 32;
+    return positions;
+}
+
+/**
+ * @brief Sets the bits of a hash code in a Bloom filter
+ */
+static void bloomAddToFilter(HashTableBloom *bloom, uint32_t hash) {
+    uint64_t *block = bloomBlock(bloom, hash);
+    uint64_t positions = bloomPositions(hash);
+    for (int i = 0; i < HASHTABLE_BLOOM_NB_HASHES; i++) {
+        unsigned position = (positions >> (9 * i)) & 511;
+        block[position >> 6] |= 1ull << (position & 63);
+    }
+    bloom->nbKeys++;
+}
+
+/**
+ * @brief Adds a hash code to a Bloom filter and to the filter being built
+ */
+static void bloomAdd(HashTableBloom *bloom, uint32_t hash) {
+    bloomAddToFilter(bloom, hash);
+    if (bloom->next != NULL) {
+        bloomAddToFilter(bloom->next, hash);
+    }
+}
+
+/**
+ * @brief Tests if the bits of a hash code are all set in a Bloom filter
+ * @return 0 if the key is not in the hash table, 1 if it may be
+ */
+static inline int bloomMayContain(HashTableBloom *bloom, uint32_t hash) {
+    uint64_t *block = bloomBlock(bloom, hash);
+    uint64_t positions = bloomPositions(hash);
+    for (int i = 0; i < HASHTABLE_BLOOM_NB_HASHES; i++) {
+        unsigned position = (positions >> (9 * i)) & 511;
+        if ((block[position >> 6] & (1ull << (position & 63))) == 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds the hash codes of the cells of a table of lists to a Bloom filter
+ */
+static void bloomAddTable(HashTableBloom *bloom, List *table, size_t sizeTable) {
+    for (size_t i = 0; i < sizeTable; i++) {
+        for (Cell *cell = table[i]; cell != NULL; cell = cell->nextCell) {
+            bloomAddToFilter(bloom, cell->hash);
+        }
+    }
+}
+
+/**
+ * @brief Replaces the blocks of a Bloom filter by those of another filter, which is freed
+ *
+ * The filter is modified in place, since it is shared by the copies of the hash table.
+ */
+static void bloomReplace(HashTableBloom *bloom, HashTableBloom *newBloom) {
+    free(bloom->blocks);
+    bloom->blocks = newBloom->blocks;
+    bloom->nbBlocks = newBloom->nbBlocks;
+    bloom->nbKeys = newBloom->nbKeys;
+    free(newBloom);
+}
+
+/**
+ * @brief Moves all the cells of a list into the buckets of a table
+ *
+ * The cells are relinked in their new bucket, they are neither copied nor freed.
+ * The bucket of a cell is computed from its stored hash code, the key is not hashed again.
+ *
+ * @param list list of cells to move
+ * @param table table of lists that receives the cells
+ * @param sizeTable size of the table
+ */
+static void moveCellsInTable(List list, List *table, size_t sizeTable) {
+    while (list != NULL) {
+        Cell *next = list->nextCell;
+        size_t index = hashtableIndex(list->hash, sizeTable);
+        list->nextCell = table[index];
+        table[index] = list;
+        list = next;
+    }
+}
+
+/**
+ * @brief Moves at most nbBuckets buckets of the old table into the new table
+ *
+ * Does nothing if no incremental resizing is in progress. The old table
+ * is freed as soon as all its buckets have been moved.
+ *
+ * @param hashtable hash table being resized
+ * @param nbBuckets maximum number of buckets to move
+ */
+static void hashtableRehashStep(HashTable hashtable, size_t nbBuckets) {
+    HashTableResize *resize = hashtable.resize;
+    if (resize == NULL || resize->oldTable == NULL) {
+        return;
+    }
+    while (nbBuckets > 0 && resize->nextBucket < resize->sizeOldTable) {
+        if (hashtable.bloom != NULL && hashtable.bloom->next != NULL) {
+            bloomAddTable(hashtable.bloom->next, &resize->oldTable[resize->nextBucket], 1);
+        }
+        moveCellsInTable(resize->oldTable[resize->nextBucket], hashtable.table, hashtable.sizeTable);
+        resize->oldTable[resize->nextBucket] = NULL;
+        resize->nextBucket++;
+        nbBuckets--;
+    }
+    if (resize->nextBucket == resize->sizeOldTable) {
+        free(resize->oldTable);
+        resize->oldTable = NULL;
+        resize->sizeOldTable = 0;
+        resize->nextBucket = 0;
+        if (hashtable.bloom != NULL && hashtable.bloom->next != NULL) {
+            bloomReplace(hashtable.bloom, hashtable.bloom->next);
+            hashtable.bloom->next = NULL;
+        }
+    }
+}
+
+#ifdef HASHTABLE_COUNTERS
+/**
+ * @brief Counts the probes of a lookup, from the list where the key was searched last
+ *
+ * A lookup of a missing key during an incremental resizing compares the
+ * cells of two lists, only the last one is counted.
+ *
+ * @param hashtable the hash table
+ * @param list the list searched
+ * @param cell the cell found in the list, NULL if the key is missing
+ */
+static void hashtableCountProbes(HashTable hashtable, List list, Cell *cell) {
+    size_t nbProbes = 0;
+    for (Cell *current = list; current != NULL; current = current->nextCell) {
+        nbProbes++;
+        if (current == cell) {
+            break;
+        }
+    }
+    if (cell != NULL) {
+        hashtable.counters->nbHits++;
+        hashtable.counters->nbProbesHit += nbProbes;
+    }
+    else {
+        hashtable.counters->nbMisses++;
+        hashtable.counters->nbProbesMiss += nbProbes;
+    }
+    if (nbProbes > hashtable.counters->maxProbes) {
+        hashtable.counters->maxProbes = nbProbes;
+    }
+}
+#endif
+
+/**
+ * @brief Finds the cell containing a key, in the table and, during an
+ * incremental resizing, in the old table
+ *
+ * @param hashtable hash table to search in
+ * @param key key to search for
+ * @param sizeKey length of the key
+ * @param hash full hash code of the key (see murmurhash32)
+ * @param bucket if not NULL, receives a pointer on the bucket containing the key
+ * @return the cell containing the key, or NULL if the key is not in the hash table
+ */
+static Cell *hashtableFindCell(HashTable hashtable, string key, size_t sizeKey, uint32_t hash, List **bucket) {
+    if (hashtable.sizeTable == 0) {
+        return NULL;
+    }
+    List *currentBucket = &hashtable.table[hashtableIndex(hash, hashtable.sizeTable)];
+    if (hashtable.bloom != NULL && !bloomMayContain(hashtable.bloom, hash)) {
+        // the filter rejects the key, the bucket is not read
+#ifdef HASHTABLE_COUNTERS
+        hashtable.counters->nbMisses++;
+        hashtable.counters->nbBloomRejections++;
+#endif
+        if (bucket != NULL) {
+            *bucket = currentBucket;
+        }
+        return NULL;
+    }
+    Cell *cell = findKeyHashInList(*currentBucket, key, sizeKey, hash);
+    if (cell == NULL && hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        currentBucket = &hashtable.resize->oldTable[hashtableIndex(hash, hashtable.resize->sizeOldTable)];
+        cell = findKeyHashInList(*currentBucket, key, sizeKey, hash);
+    }
+#ifdef HASHTABLE_COUNTERS
+    hashtableCountProbes(hashtable, *currentBucket, cell);
+#endif
+    if (bucket != NULL) {
+        *bucket = currentBucket;
+    }
+    return cell;
+}
+
+/**
+ * @brief Changes the size of the table of the hash table
+ *
+ * If the resizing is incremental, the current table becomes the old table
+ * and its buckets will be moved by the next operations. Otherwise, all the
+ * cells are moved at once into the new table and the current table is freed.
+ *
+ * @param hashtable pointer on the hash table to resize
+ * @param newSize the new size of the table, at least 1
+ */
+static void hashtableResizeTable(HashTable *hashtable, size_t newSize) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    List *newTable = (List *)calloc(newSize, sizeof(List));
+    if (hashtable->resize != NULL) {
+        hashtableRehashStep(*hashtable, SIZE_MAX);
+        hashtable->resize->oldTable = hashtable->table;
+        hashtable->resize->sizeOldTable = hashtable->sizeTable;
+        hashtable->resize->nextBucket = 0;
+        if (hashtable->bloom != NULL) {
+            // filled while the buckets are moved
+            hashtable->bloom->next = bloomCreate(newSize);
+        }
+    }
+    else {
+        for (size_t i = 0; i < hashtable->sizeTable; i++) {
+            moveCellsInTable(hashtable->table[i], newTable, newSize);
+        }
+        free(hashtable->table);
+        if (hashtable->bloom != NULL) {
+            HashTableBloom *bloom = bloomCreate(newSize);
+            bloomAddTable(bloom, newTable, newSize);
+            bloomReplace(hashtable->bloom, bloom);
+        }
+    }
+    hashtable->table = newTable;
+    hashtable->sizeTable = newSize;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    hashtable->nbResizes++;
+    hashtable->resizeTime += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+}
+
+/**
+ * @brief Doubles the size of the table of the hash table
+ *
+ * @param hashtable pointer on the hash table to resize
+ */
+static void hashtableGrow(HashTable *hashtable) {
+    hashtableResizeTable(hashtable, hashtable->sizeTable == 0 ? 1 : 2 * hashtable->sizeTable);
+}
+
+/**
+ * @brief Halves the size of the table of the hash table if it has
+ * less than minLoadFactor pairs per list
+ *
+ * @param hashtable pointer on the hash table
+ */
+static void hashtableShrinkIfSparse(HashTable *hashtable) {
+    if (hashtable->minLoadFactor > 0 && hashtable->sizeTable > 1
+        && (double)hashtable->numberOfPairs < hashtable->minLoadFactor * hashtable->sizeTable) {
+        hashtableResizeTable(hashtable, hashtable->sizeTable / 2);
+    }
+}
+
+
+/**
+ * @brief Gives size bytes in the arena, aligned for a Cell
+ *
+ * A new chunk is allocated when the last one is full. A request larger
+ * than the default chunk size gets a chunk of its own.
+ *
+ * @param arena the arena
+ * @param size the number of bytes
+ * @return a pointer on the bytes
+ */
+static void *arenaAllocate(HashTableArena *arena, size_t size) {
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    HashTableArenaChunk *chunk = arena->chunks;
+    if (chunk == NULL || chunk->used + size > chunk->size) {
+        size_t sizeChunk = size > HASHTABLE_ARENA_CHUNK_SIZE ? size : HASHTABLE_ARENA_CHUNK_SIZE;
+        chunk = (HashTableArenaChunk *)malloc(sizeof(HashTableArenaChunk) + sizeChunk);
+        chunk->size = sizeChunk;
+        chunk->used = 0;
+        chunk->nextChunk = arena->chunks;
+        arena->chunks = chunk;
+        arena->nbChunks++;
+    }
+    void *bytes = (char *)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    return bytes;
+}
+
+/**
+ * @brief Tells if the key of a cell of the hash table is allocated with the cell
+ *
+ * @param hashtable the hash table
+ * @param cell a cell of the hash table
+ * @return 1 if the key is right after the cell, 0 if it is allocated on its own
+ */
+static inline int hashtableHasInlineKey(HashTable hashtable, Cell *cell) {
+    return hashtable.arena != NULL
+        || (hashtable.inlineKeys && cell->sizeKey <= HASHTABLE_INLINE_KEY_SIZE);
+}
+
+/**
+ * @brief Adds a new pair at the beginning of a list of the hash table
+ *
+ * The cell and the copy of the key are taken in the arena of the hash
+ * table if it has one. Otherwise a short key of a hash table with inline
+ * keys is allocated with its cell, and the other pairs are allocated by
+ * the list.
+ *
+ * @return A pointer to the modified list, whose first cell is the new pair
+ */
+static List hashtableAddInList(HashTable *hashtable, List list, string key, size_t sizeKey, int value, uint32_t hash) {
+    Cell *cell;
+    if (hashtable->arena != NULL) {
+        cell = (Cell *)arenaAllocate(hashtable->arena, sizeof(Cell) + sizeKey + 1);
+    }
+    else if (hashtable->inlineKeys && sizeKey <= HASHTABLE_INLINE_KEY_SIZE) {
+        cell = (Cell *)malloc(sizeof(Cell) + sizeKey + 1);
+    }
+    else {
+        return addKeyValueHashInList(list, key, sizeKey, value, hash);
+    }
+    cell->key = (string)(cell + 1);
+    memcpy(cell->key, key, sizeKey);
+    cell->key[sizeKey] = '\0';
+    cell->sizeKey = sizeKey;
+    cell->value = value;
+    cell->hash = hash;
+    cell->nextCell = list;
+    return cell;
+}
+
+/**
+ * @brief Frees a cell of a hash table without an arena
+ *
+ * @param hashtable the hash table
+ * @param cell the cell to free, already unlinked from its list
+ */
+static void freeHashCell(HashTable hashtable, Cell *cell) {
+    if (!hashtableHasInlineKey(hashtable, cell)) {
+        free(cell->key);
+    }
+    free(cell);
+}
+
+/**
+ * @brief Frees a list of a hash table without an arena
+ *
+ * It replaces freeList, which does not know the inline keys.
+ *
+ * @param hashtable the hash table
+ * @param list the list to free
+ */
+static void freeHashList(HashTable hashtable, List list) {
+    while (list != NULL) {
+        Cell *next = list->nextCell;
+        freeHashCell(hashtable, list);
+        list = next;
+    }
+}
+
+/**
+ * @brief Finds the cell containing a key, or adds a new pair if the key is
+ * not in the hash table (the table is resized if necessary)
+ *
+ * This is the single probe shared by all the insertions: the key is hashed
+ * once and its bucket is traversed once.
+ *
+ * @param hashtable pointer on the hash table
+ * @param key the key to search for or to add
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key
+ * @param value the value of the new pair if the key is added
+ * @param added if not NULL, receives 1 if the pair has been added, 0 otherwise
+ * @return the cell containing the key
+ */
+static Cell *hashtableFindOrAddCell(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash, int value, int *added) {
+    hashtableRehashStep(*hashtable, HASHTABLE_REHASH_STEP);
+    Cell *cell = hashtableFindCell(*hashtable,key,sizeKey,hash,NULL);
+    if (added != NULL) {
+        *added = (cell == NULL);
+    }
+    if (cell != NULL) {
+        return cell;
+    }
+    if ((double)hashtable->numberOfPairs >= hashtable->maxLoadFactor * hashtable->sizeTable) {
+        hashtableGrow(hashtable);
+    }
+    size_t index = hashtableIndex(hash, hashtable->sizeTable);
+    hashtable->table[index] = hashtableAddInList(hashtable,hashtable->table[index],key,sizeKey,value,hash);
+    hashtable->numberOfPairs++;
+    if (hashtable->bloom != NULL) {
+        bloomAdd(hashtable->bloom, hash);
+    }
+    return hashtable->table[index];
 }
 
 
@@ -100,6 +594,14 @@ void hashtablePrint(HashTable hashtable) {
     }
     else
         printf("NULL table\n");
+    if(hashtable.resize!=NULL && hashtable.resize->oldTable!=NULL){
+        printf("Old table (resizing from bucket %zu):\n", hashtable.resize->nextBucket);
+        for (size_t i = hashtable.resize->nextBucket; i < hashtable.resize->sizeOldTable; i++) {
+            printf("%zu: ", i);
+            printList(hashtable.resize->oldTable[i],0);
+            printf("\n");
+        }
+    }
     printf("---\n");
 }
 
@@ -116,17 +618,220 @@ HashTable hashtableCreate(size_t sizeTable) {
     hashtable.sizeTable=sizeTable;
     hashtable.numberOfPairs=0;
     if (sizeTable > 0) {
-        hashtable.table = (List *)malloc(sizeTable*sizeof(List));
-        for (size_t i=0;i<sizeTable;i++) {
-            hashtable.table[i] = NULL;
-        }
+        // calloc returns zeroed memory (empty lists), which large blocks get
+        // lazily from the system instead of being cleared here
+        hashtable.table = (List *)calloc(sizeTable, sizeof(List));
     } else {
         hashtable.table = NULL;
     }
+    hashtable.resize = NULL;
+    hashtable.arena = NULL;
+    hashtable.inlineKeys = 0;
+    hashtable.hashFunction = NULL;
+    hashtable.bloom = NULL;
+    hashtable.nbResizes = 0;
+    hashtable.resizeTime = 0;
+    hashtable.maxLoadFactor = HASHTABLE_MAX_LOAD_FACTOR;
+    hashtable.minLoadFactor = HASHTABLE_MIN_LOAD_FACTOR;
+#ifdef HASHTABLE_COUNTERS
+    hashtable.counters = (HashTableCounters *)calloc(1, sizeof(HashTableCounters));
+#else
+    hashtable.counters = NULL;
+#endif
     return hashtable;
 }
 
 
+/**
+ * Create a new hash table whose keys are hashed with the given function.
+ *
+ * @param sizeTable the minimal size of the table
+ * @param hashFunction the hash function, NULL for murmurhash32
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithHash(size_t sizeTable, HashFunction hashFunction) {
+    size_t size = 1;
+    while (size < sizeTable) {
+        size *= 2;
+    }
+    HashTable hashtable = hashtableCreate(size);
+    hashtable.hashFunction = hashFunction;
+    return hashtable;
+}
+
+
+/**
+ * Change the hash function of a hash table. The pairs already in the
+ * hash table are hashed again with the new function.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param hashFunction the hash function, NULL for murmurhash32
+ */
+void hashtableSetHashFunction(HashTable *hashtable, HashFunction hashFunction) {
+    hashtableRehashStep(*hashtable, SIZE_MAX);
+    hashtable->hashFunction = hashFunction;
+    if (hashtable->sizeTable == 0) {
+        return;
+    }
+    List *table = hashtable->table;
+    hashtable->table = (List *)calloc(hashtable->sizeTable, sizeof(List));
+    for (size_t i = 0; i < hashtable->sizeTable; i++) {
+        Cell *cell = table[i];
+        while (cell != NULL) {
+            Cell *next = cell->nextCell;
+            cell->hash = hashtableHash(*hashtable, cell->key, cell->sizeKey);
+            size_t index = hashtableIndex(cell->hash, hashtable->sizeTable);
+            cell->nextCell = hashtable->table[index];
+            hashtable->table[index] = cell;
+            cell = next;
+        }
+    }
+    free(table);
+    if (hashtable->bloom != NULL) {
+        HashTableBloom *bloom = bloomCreate(hashtable->sizeTable);
+        bloomAddTable(bloom, hashtable->table, hashtable->sizeTable);
+        bloomReplace(hashtable->bloom, bloom);
+    }
+}
+
+
+/**
+ * Create a new hash table with the given size, whose cells and keys
+ * are allocated in an arena.
+ *
+ * @param sizeTable the size of the table
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithArena(size_t sizeTable) {
+    HashTable hashtable = hashtableCreate(sizeTable);
+    hashtable.arena = (HashTableArena *)malloc(sizeof(HashTableArena));
+    hashtable.arena->chunks = NULL;
+    hashtable.arena->nbChunks = 0;
+    return hashtable;
+}
+
+
+/**
+ * Create a new hash table with the given size, whose short keys are
+ * allocated with their cell.
+ *
+ * @param sizeTable the size of the table
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithInlineKeys(size_t sizeTable) {
+    HashTable hashtable = hashtableCreate(sizeTable);
+    hashtable.inlineKeys = 1;
+    return hashtable;
+}
+
+
+/**
+ * Add or remove the Bloom filter of the hash table.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param enabled 1 to add the Bloom filter, 0 to remove it
+ */
+void hashtableSetBloomFilter(HashTable *hashtable, int enabled) {
+    if (enabled && hashtable->bloom == NULL) {
+        hashtableRehashStep(*hashtable, SIZE_MAX);
+        hashtable->bloom = bloomCreate(hashtable->sizeTable);
+        bloomAddTable(hashtable->bloom, hashtable->table, hashtable->sizeTable);
+    }
+    else if (!enabled && hashtable->bloom != NULL) {
+        bloomFree(hashtable->bloom);
+        hashtable->bloom = NULL;
+    }
+}
+
+
+/**
+ * Estimate the false positive rate of the Bloom filter of the hash table.
+ *
+ * @param hashtable the hash table
+ * @return the estimated false positive rate, -1 if the hash table has no Bloom filter
+ */
+double hashtableBloomFalsePositiveRate(HashTable hashtable) {
+    if (hashtable.bloom == NULL) {
+        return -1;
+    }
+    // a key of a block is accepted if its bits are among the bits set in the block
+    double rate = 0;
+    for (size_t b = 0; b < hashtable.bloom->nbBlocks; b++) {
+        int nbBits = 0;
+        for (int w = 0; w < BLOOM_BLOCK_WORDS; w++) {
+            nbBits += __builtin_popcountll(hashtable.bloom->blocks[BLOOM_BLOCK_WORDS * b + w]);
+        }
+        double blockRate = 1;
+        for (int i = 0; i < HASHTABLE_BLOOM_NB_HASHES; i++) {
+            blockRate *= nbBits / 512.0;
+        }
+        rate += blockRate;
+    }
+    return rate / hashtable.bloom->nbBlocks;
+}
+
+
+/**
+ * Enable or disable the incremental resizing of the hash table.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param incremental 1 to enable the incremental resizing, 0 to disable it
+ */
+void hashtableSetIncremental(HashTable *hashtable, int incremental) {
+    if (incremental && hashtable->resize == NULL) {
+        hashtable->resize = (HashTableResize *)malloc(sizeof(HashTableResize));
+        hashtable->resize->oldTable = NULL;
+        hashtable->resize->sizeOldTable = 0;
+        hashtable->resize->nextBucket = 0;
+    }
+    else if (!incremental && hashtable->resize != NULL) {
+        hashtableRehashStep(*hashtable, SIZE_MAX);
+        free(hashtable->resize);
+        hashtable->resize = NULL;
+    }
+}
+
+
+/**
+ * Set the load factors of the hash table.
+ *
+ * hashtableInsert doubles the size of the table when the number of pairs
+ * reaches maxLoadFactor times the size, and hashtableRemove halves it when
+ * the number of pairs falls below minLoadFactor times the size.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param maxLoadFactor the maximal number of pairs per list, larger than 0
+ * @param minLoadFactor the minimal number of pairs per list, 0 to never
+ * shrink the table, at most maxLoadFactor/4
+ */
+void hashtableSetLoadFactors(HashTable *hashtable, double maxLoadFactor, double minLoadFactor) {
+    if (!(maxLoadFactor > 0) || minLoadFactor < 0 || minLoadFactor > maxLoadFactor / 4) {
+        printf("Error:invalid load factors\n");
+        return;
+    }
+    hashtable->maxLoadFactor = maxLoadFactor;
+    hashtable->minLoadFactor = minLoadFactor;
+}
+
+
+/**
+ * Make room for nbPairs pairs in the hash table.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param nbPairs the number of pairs the hash table will hold
+ */
+void hashtableReserve(HashTable *hashtable, size_t nbPairs) {
+    // doubling keeps the size a power of two if it is one
+    size_t newSize = hashtable->sizeTable == 0 ? 1 : hashtable->sizeTable;
+    while ((double)nbPairs >= hashtable->maxLoadFactor * newSize) {
+        newSize *= 2;
+    }
+    if (newSize > hashtable->sizeTable) {
+        hashtableResizeTable(hashtable, newSize);
+    }
+}
+
+
 
 /**
  * Insert a new key-value pair into the hash table but the insertion
@@ -144,19 +849,32 @@ HashTable hashtableCreate(size_t sizeTable) {
  * a pointer on the hash table.
  */
 void hashtableInsertWithoutResizing(HashTable *hashtable, string key, int value){
-    size_t index = murmurhash(key,strlen(key),hashtable->sizeTable);
-    List currentList = hashtable->table[index];
-    Cell *cell = findKeyInList(currentList,key);
+    hashtableInsertWithoutResizingLen(hashtable,key,strlen(key),value);
+}
+
+/**
+ * Same as hashtableInsertWithoutResizing, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param value the value for the new pair
+ */
+void hashtableInsertWithoutResizingLen(HashTable *hashtable, string key, size_t sizeKey, int value){
+    hashtableRehashStep(*hashtable, HASHTABLE_REHASH_STEP);
+    uint32_t hash = hashtableHash(*hashtable,key,sizeKey);
+    Cell *cell = hashtableFindCell(*hashtable,key,sizeKey,hash,NULL);
     if(cell!=NULL){
         cell->value=value;
     }
     else{
-        hashtable->table[index]=addKeyValueInList(currentList,key,value);
+        size_t index = hashtableIndex(hash, hashtable->sizeTable);
+        hashtable->table[index]=hashtableAddInList(hashtable,hashtable->table[index],key,sizeKey,value,hash);
         hashtable->numberOfPairs++;
+        if(hashtable->bloom!=NULL){
+            bloomAdd(hashtable->bloom,hash);
+        }
     }
-    
-    
-
 }
 
 
@@ -170,16 +888,60 @@ void hashtableInsertWithoutResizing(HashTable *hashtable, string key, int value)
  * @param hashtable hash table to free
  */
 void hashtableDestroy(HashTable *hashtable) {
-    for (size_t i=0;i<hashtable->sizeTable;i++) {
-        freeList(hashtable->table[i]);
+    // with an arena, the cells are freed with the chunks
+    if (hashtable->arena == NULL) {
+        for (size_t i=0;i<hashtable->sizeTable;i++) {
+            freeHashList(*hashtable, hashtable->table[i]);
+        }
     }
     free(hashtable->table);
+    if (hashtable->resize != NULL) {
+        if (hashtable->arena == NULL) {
+            for (size_t i=0;i<hashtable->resize->sizeOldTable;i++) {
+                freeHashList(*hashtable, hashtable->resize->oldTable[i]);
+            }
+        }
+        free(hashtable->resize->oldTable);
+        free(hashtable->resize);
+        hashtable->resize=NULL;
+    }
+    bloomFree(hashtable->bloom);
+    hashtable->bloom=NULL;
+    free(hashtable->counters);
+    hashtable->counters=NULL;
+    if (hashtable->arena != NULL) {
+        HashTableArenaChunk *chunk = hashtable->arena->chunks;
+        while (chunk != NULL) {
+            HashTableArenaChunk *next = chunk->nextChunk;
+            free(chunk);
+            chunk = next;
+        }
+        free(hashtable->arena);
+        hashtable->arena=NULL;
+    }
     hashtable->sizeTable=0;
     hashtable->numberOfPairs=0;
     hashtable->table=NULL;
     return;
 }
 
+/**
+ * @brief Adds a copy of the pairs of a list to a hash table, without resizing it
+ *
+ * The keys are distinct and their hash codes are stored in the cells,
+ * so the pairs are directly added to their bucket.
+ *
+ * @param hashtable the hash table, that does not contain the keys of the list
+ * @param list the list whose pairs are copied
+ */
+static void copyCellsInTable(HashTable *hashtable, List list) {
+    for (Cell *cell = list; cell != NULL; cell = cell->nextCell) {
+        size_t index = hashtableIndex(cell->hash, hashtable->sizeTable);
+        hashtable->table[index] = hashtableAddInList(hashtable, hashtable->table[index], cell->key, cell->sizeKey, cell->value, cell->hash);
+        hashtable->numberOfPairs++;
+    }
+}
+
 /**
  * Returns a new hash table whose table size is the double
  * of the input hashtable and that contains all the pairs
@@ -193,27 +955,18 @@ void hashtableDestroy(HashTable *hashtable) {
 HashTable hashtableDoubleSize(HashTable hashtable) {
     HashTable newHashtable;
     newHashtable = hashtableCreate(2 * hashtable.sizeTable);
+    newHashtable.hashFunction = hashtable.hashFunction;
+    newHashtable.inlineKeys = hashtable.inlineKeys;
+    newHashtable.maxLoadFactor = hashtable.maxLoadFactor;
+    newHashtable.minLoadFactor = hashtable.minLoadFactor;
     for (size_t i = 0; i < hashtable.sizeTable; i++) {
-        Cell* currentList = hashtable.table[i];
-        Cell* reversedList = NULL;
-        Cell* newCell;
-        while (currentList != NULL) {
-            newCell = malloc(sizeof(Cell));
-            newCell->key = currentList->key;
-            newCell->value = currentList->value;
-            newCell->nextCell = reversedList;
-            reversedList = newCell;
-            currentList = currentList->nextCell;
+        copyCellsInTable(&newHashtable, hashtable.table[i]);
+    }
+    // the buckets of the old table not moved yet
+    if (hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        for (size_t i = hashtable.resize->nextBucket; i < hashtable.resize->sizeOldTable; i++) {
+            copyCellsInTable(&newHashtable, hashtable.resize->oldTable[i]);
         }
-        currentList = reversedList;
-        do {
-            if (currentList != NULL) {
-                hashtableInsertWithoutResizing(&newHashtable, currentList->key, currentList->value);
-                Cell* temp = currentList;
-                currentList = currentList->nextCell;
-                free(temp);
-            }
-        } while (currentList != NULL);
     }
     return newHashtable;
 }
@@ -236,13 +989,111 @@ HashTable hashtableDoubleSize(HashTable hashtable) {
  * Pay attention to the memory !
  */
 void hashtableInsert(HashTable *hashtable, string key,  int value){
-    if(hashtable->numberOfPairs>=hashtable->sizeTable){
-        *hashtable=hashtableDoubleSize(*hashtable);
+    hashtableInsertLen(hashtable,key,strlen(key),value);
+}
+
+/**
+ * Same as hashtableInsert, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table to insert into, supposed not to be null.
+ * @param key the key for the new pair, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param value the value for the new pair
+ */
+void hashtableInsertLen(HashTable *hashtable, string key, size_t sizeKey, int value){
+    hashtableInsertHash(hashtable,key,sizeKey,hashtableHash(*hashtable,key,sizeKey),value);
+}
+
+/**
+ * Same as hashtableInsertLen, for a key whose hash code is already known.
+ *
+ * @param hashtable pointer on the hash table to insert into, supposed not to be null.
+ * @param key the key for the new pair, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @param value the value for the new pair
+ */
+void hashtableInsertHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash, int value){
+    int added;
+    Cell *cell = hashtableFindOrAddCell(hashtable,key,sizeKey,hash,value,&added);
+    if(!added){
+        cell->value=value;
     }
-    hashtableInsertWithoutResizing(hashtable,key,value);
     return;
 }
 
+/**
+ * Get a pointer on the value associated with the given key, after
+ * inserting the pair (key,defaultValue) if the key is not in the hash table.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key to search for or to insert
+ * @param defaultValue the value of the new pair if the key is inserted
+ * @return a pointer on the value associated to the key, valid until the key
+ * is removed, the hash table is destroyed, or its cells are copied by
+ * hashtableDoubleSize or hashtableMerge (the automatic resizings keep it)
+ */
+int *hashtableGetOrInsert(HashTable *hashtable, string key, int defaultValue){
+    return hashtableGetOrInsertLen(hashtable,key,strlen(key),defaultValue);
+}
+
+/**
+ * Same as hashtableGetOrInsert, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key to search for or to insert, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param defaultValue the value of the new pair if the key is inserted
+ * @return a pointer on the value associated to the key, valid until the key
+ * is removed, the hash table is destroyed, or its cells are copied by
+ * hashtableDoubleSize or hashtableMerge (the automatic resizings keep it)
+ */
+int *hashtableGetOrInsertLen(HashTable *hashtable, string key, size_t sizeKey, int defaultValue){
+    return &hashtableFindOrAddCell(hashtable,key,sizeKey,hashtableHash(*hashtable,key,sizeKey),defaultValue,NULL)->value;
+}
+
+/**
+ * Add delta to the value associated with the given key. A missing
+ * key is inserted with the value delta.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrement(HashTable *hashtable, string key, int delta){
+    return hashtableIncrementLen(hashtable,key,strlen(key),delta);
+}
+
+/**
+ * Same as hashtableIncrement, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrementLen(HashTable *hashtable, string key, size_t sizeKey, int delta){
+    return hashtableIncrementHash(hashtable,key,sizeKey,hashtableHash(*hashtable,key,sizeKey),delta);
+}
+
+/**
+ * Same as hashtableIncrementLen, for a key whose hash code is already known.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrementHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash, int delta){
+    Cell *cell = hashtableFindOrAddCell(hashtable,key,sizeKey,hash,0,NULL);
+    cell->value+=delta;
+    return cell->value;
+}
+
 /**
  * Test if a key is in the hash table.
  * @param hashtable the hash table to search in
@@ -250,9 +1101,30 @@ void hashtableInsert(HashTable *hashtable, string key,  int value){
  * @return 1 if the key is in the table, 0 otherwise.
  */
 int hashtableHasKey(HashTable hashtable, string key){
-    size_t index = murmurhash(key,strlen(key),hashtable.sizeTable);
-    List currentList = hashtable.table[index];
-    Cell *cell = findKeyInList(currentList,key);
+    return hashtableHasKeyLen(hashtable,key,strlen(key));
+}
+
+/**
+ * Same as hashtableHasKey, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int hashtableHasKeyLen(HashTable hashtable, string key, size_t sizeKey){
+    return hashtableHasKeyHash(hashtable,key,sizeKey,hashtableHash(hashtable,key,sizeKey));
+}
+
+/**
+ * Same as hashtableHasKeyLen, for a key whose hash code is already known.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int hashtableHasKeyHash(HashTable hashtable, string key, size_t sizeKey, uint32_t hash){
+    Cell *cell = hashtableFindCell(hashtable,key,sizeKey,hash,NULL);
     if(cell!=NULL){
         return 1;
     }
@@ -268,9 +1140,30 @@ int hashtableHasKey(HashTable hashtable, string key){
  * @return the value associated to the key
  */
 int hashtableGetValue(HashTable hashtable, string key){
-    size_t index = murmurhash(key,strlen(key),hashtable.sizeTable);
-    List currentList = hashtable.table[index];
-    Cell *cell = findKeyInList(currentList,key);
+    return hashtableGetValueLen(hashtable,key,strlen(key));
+}
+
+/**
+ * Same as hashtableGetValue, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int hashtableGetValueLen(HashTable hashtable, string key, size_t sizeKey){
+    return hashtableGetValueHash(hashtable,key,sizeKey,hashtableHash(hashtable,key,sizeKey));
+}
+
+/**
+ * Same as hashtableGetValueLen, for a key whose hash code is already known.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int hashtableGetValueHash(HashTable hashtable, string key, size_t sizeKey, uint32_t hash){
+    Cell *cell = hashtableFindCell(hashtable,key,sizeKey,hash,NULL);
     if(cell!=NULL){
         return cell->value;
     }
@@ -278,6 +1171,106 @@ int hashtableGetValue(HashTable hashtable, string key){
 }
 
 
+/**
+ * @brief Looks up a group of at most HASHTABLE_BATCH_SIZE keys
+ *
+ * Each step issues the memory accesses of all the keys of the group
+ * before the next step uses them. With a Bloom filter, the blocks of
+ * the keys are read first, and the rejected keys are not looked up.
+ *
+ * @param hashtable the hash table to search in
+ * @param keys the keys of the group
+ * @param sizeKeys the lengths of the keys
+ * @param nbKeys the number of keys of the group
+ * @param values array that receives the values of the keys
+ */
+static void hashtableGetValuesBatch(HashTable hashtable, string *keys, size_t *sizeKeys, size_t nbKeys, int *values) {
+    uint32_t hashes[HASHTABLE_BATCH_SIZE];
+    List *buckets[HASHTABLE_BATCH_SIZE];
+    for (size_t i = 0; i < nbKeys; i++) {
+        hashes[i] = hashtableHash(hashtable, keys[i], sizeKeys[i]);
+        if (hashtable.bloom != NULL) {
+            __builtin_prefetch(bloomBlock(hashtable.bloom, hashes[i]));
+        }
+    }
+    for (size_t i = 0; i < nbKeys; i++) {
+        if (hashtable.bloom != NULL && !bloomMayContain(hashtable.bloom, hashes[i])) {
+            // rejected by the filter
+            buckets[i] = NULL;
+            continue;
+        }
+        buckets[i] = &hashtable.table[hashtableIndex(hashes[i], hashtable.sizeTable)];
+        __builtin_prefetch(buckets[i]);
+    }
+    for (size_t i = 0; i < nbKeys; i++) {
+        if (buckets[i] != NULL && *buckets[i] != NULL) {
+            __builtin_prefetch(*buckets[i]);
+        }
+    }
+    for (size_t i = 0; i < nbKeys; i++) {
+        Cell *head = buckets[i] != NULL ? *buckets[i] : NULL;
+        if (head != NULL && head->hash == hashes[i]) {
+            __builtin_prefetch(head->key);
+        }
+    }
+    for (size_t i = 0; i < nbKeys; i++) {
+        if (buckets[i] == NULL) {
+            values[i] = -1;
+            continue;
+        }
+        Cell *cell = findKeyHashInList(*buckets[i], keys[i], sizeKeys[i], hashes[i]);
+        if (cell == NULL && hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+            // the key may not have been moved to the new table yet
+            cell = hashtableFindCell(hashtable, keys[i], sizeKeys[i], hashes[i], NULL);
+        }
+        values[i] = cell != NULL ? cell->value : -1;
+    }
+}
+
+
+/**
+ * Get the values associated with several keys.
+ *
+ * @param hashtable the hash table to search in
+ * @param keys array of the nbKeys keys to search for
+ * @param nbKeys the number of keys
+ * @param values array that receives the nbKeys values
+ */
+void hashtableGetValues(HashTable hashtable, string *keys, size_t nbKeys, int *values){
+    size_t sizeKeys[HASHTABLE_BATCH_SIZE];
+    for (size_t start = 0; start < nbKeys; start += HASHTABLE_BATCH_SIZE) {
+        size_t nbBatch = nbKeys - start < HASHTABLE_BATCH_SIZE ? nbKeys - start : HASHTABLE_BATCH_SIZE;
+        for (size_t i = 0; i < nbBatch; i++) {
+            sizeKeys[i] = strlen(keys[start + i]);
+        }
+        hashtableGetValuesLen(hashtable, keys + start, sizeKeys, nbBatch, values + start);
+    }
+}
+
+
+/**
+ * Same as hashtableGetValues, for keys given with their lengths.
+ *
+ * @param hashtable the hash table to search in
+ * @param keys array of the nbKeys keys to search for
+ * @param sizeKeys array of the lengths of the keys
+ * @param nbKeys the number of keys
+ * @param values array that receives the nbKeys values
+ */
+void hashtableGetValuesLen(HashTable hashtable, string *keys, size_t *sizeKeys, size_t nbKeys, int *values){
+    if (hashtable.sizeTable == 0) {
+        for (size_t i = 0; i < nbKeys; i++) {
+            values[i] = -1;
+        }
+        return;
+    }
+    for (size_t start = 0; start < nbKeys; start += HASHTABLE_BATCH_SIZE) {
+        size_t nbBatch = nbKeys - start < HASHTABLE_BATCH_SIZE ? nbKeys - start : HASHTABLE_BATCH_SIZE;
+        hashtableGetValuesBatch(hashtable, keys + start, sizeKeys + start, nbBatch, values + start);
+    }
+}
+
+
 /**
  * Remove the key-value pair with the given key from the hash table.
  *
@@ -287,25 +1280,145 @@ int hashtableGetValue(HashTable hashtable, string key){
  * @return 0 if the key was not in the hash table, 1 otherwise
  */
 int hashtableRemove(HashTable *hashtable, string key){
-    size_t index = murmurhash(key,strlen(key),hashtable->sizeTable);
-    List currentList = hashtable->table[index];
-    Cell *cell = findKeyInList(currentList,key);
+    return hashtableRemoveLen(hashtable,key,strlen(key));
+}
+
+/**
+ * Same as hashtableRemove, for a key given with its length.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int hashtableRemoveLen(HashTable *hashtable, string key, size_t sizeKey){
+    return hashtableRemoveHash(hashtable,key,sizeKey,hashtableHash(*hashtable,key,sizeKey));
+}
+
+/**
+ * Same as hashtableRemoveLen, for a key whose hash code is already known.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int hashtableRemoveHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash){
+    hashtableRehashStep(*hashtable, HASHTABLE_REHASH_STEP);
+    List *bucket;
+    Cell *cell = hashtableFindCell(*hashtable,key,sizeKey,hash,&bucket);
     if(cell!=NULL){
-        hashtable->table[index]=delKeyInList(currentList,key);
+        if(hashtable->arena==NULL){
+            *bucket=unlinkCellInList(*bucket,cell);
+            freeHashCell(*hashtable,cell);
+        }
+        else{
+            // the memory of the cell is given back with the arena
+            *bucket=unlinkCellInList(*bucket,cell);
+        }
         hashtable->numberOfPairs--;
+        hashtableShrinkIfSparse(hashtable);
         return 1;
 
     }
     return 0;
 }
 
+/**
+ * @brief Moves the pairs of a list of the source into the destination
+ *
+ * @param destination pointer on the hash table that receives the pairs,
+ * large enough and not being resized
+ * @param source the hash table the list comes from
+ * @param list the list of pairs to move
+ * @param combine the function combining the values of a key present in both tables
+ */
+static void hashtableMergeList(HashTable *destination, HashTable source, List list, CombineFunction combine) {
+    // a cell keeps its memory if both tables free their cells the same way
+    int moveCells = (destination->arena == NULL) == (source.arena == NULL)
+                    && destination->inlineKeys == source.inlineKeys;
+    while (list != NULL) {
+        Cell *cell = list;
+        list = list->nextCell;
+        uint32_t hash = cell->hash;
+        if (destination->hashFunction != source.hashFunction) {
+            hash = hashtableHash(*destination, cell->key, cell->sizeKey);
+        }
+        Cell *found = hashtableFindCell(*destination, cell->key, cell->sizeKey, hash, NULL);
+        if (found != NULL) {
+            found->value = combine == NULL ? cell->value : combine(found->value, cell->value);
+        }
+        else {
+            size_t index = hashtableIndex(hash, destination->sizeTable);
+            if (moveCells) {
+                cell->hash = hash;
+                cell->nextCell = destination->table[index];
+                destination->table[index] = cell;
+            }
+            else {
+                destination->table[index] = hashtableAddInList(destination, destination->table[index],
+                                                               cell->key, cell->sizeKey, cell->value, hash);
+            }
+            destination->numberOfPairs++;
+            if (destination->bloom != NULL) {
+                bloomAdd(destination->bloom, hash);
+            }
+        }
+        if (found == NULL && moveCells) {
+            continue;
+        }
+        // the cell is not moved: it is freed, unless it is in an arena
+        if (source.arena == NULL) {
+            freeHashCell(source, cell);
+        }
+    }
+}
+
+/**
+ * Move all the pairs of a hash table into another one.
+ *
+ * @param destination pointer on the hash table that receives the pairs
+ * @param source pointer on the hash table whose pairs are moved, destroyed
+ * by the merge as by hashtableDestroy
+ * @param combine the function combining the values of a key present in
+ * both tables, NULL to keep the value of the source
+ */
+void hashtableMerge(HashTable *destination, HashTable *source, CombineFunction combine) {
+    if (destination == source) {
+        return;
+    }
+    // a single resizing, for the case where no key is in both tables
+    hashtableReserve(destination, destination->numberOfPairs + source->numberOfPairs);
+    hashtableRehashStep(*destination, SIZE_MAX);
+    hashtableRehashStep(*source, SIZE_MAX);
+    for (size_t i = 0; i < source->sizeTable; i++) {
+        hashtableMergeList(destination, *source, source->table[i], combine);
+        source->table[i] = NULL;
+    }
+    if (source->arena != NULL && destination->arena != NULL) {
+        // the moved cells are in the chunks of the source, which are kept
+        // after the chunks of the destination
+        HashTableArenaChunk **last = &destination->arena->chunks;
+        while (*last != NULL) {
+            last = &(*last)->nextChunk;
+        }
+        *last = source->arena->chunks;
+        destination->arena->nbChunks += source->arena->nbChunks;
+        source->arena->chunks = NULL;
+        source->arena->nbChunks = 0;
+    }
+    hashtableDestroy(source);
+}
+
+
 /**
  * Returns the number of cellules in the hash table
  * @param hashtable the hash table to count
  * @return the number of cellules in the hash table
  */
 long long int NumberofCellules(HashTable hashtable){
-   long long int count=0;
+    long long int count=0;
     for (size_t i = 0; i < hashtable.sizeTable; i++) {
         List currentList = hashtable.table[i];
         while (currentList != NULL) {
@@ -313,6 +1426,14 @@ long long int NumberofCellules(HashTable hashtable){
             currentList = currentList->nextCell;
         }
     }
+    // the buckets of the old table not moved yet
+    if (hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        for (size_t i = hashtable.resize->nextBucket; i < hashtable.resize->sizeOldTable; i++) {
+            for (Cell *cell = hashtable.resize->oldTable[i]; cell != NULL; cell = cell->nextCell) {
+                count++;
+            }
+        }
+    }
     return count;
 }
 
@@ -330,35 +1451,116 @@ long long int SumofValues(HashTable hashtable){
             currentList = currentList->nextCell;
         }
     }
+    // the buckets of the old table not moved yet
+    if (hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        for (size_t i = hashtable.resize->nextBucket; i < hashtable.resize->sizeOldTable; i++) {
+            for (Cell *cell = hashtable.resize->oldTable[i]; cell != NULL; cell = cell->nextCell) {
+                sum+=(long long int)cell->value;
+            }
+        }
+    }
     return sum;
 }
 
 
 /**
- * Prints the number of words and distinct words in the file
- * "potter-clean.txt"
+ * @brief Returns the statistics of the hash table
  *
+ * @param hashtable the hash table
+ * @return the statistics of the hash table
  */
-void countDistinctWordsInBook(){
-    FILE *file = fopen("potter-clean.txt", "r");
-    if (file == NULL) {
-        printf("Error:file not found\n");
-        return;
+HashTableStats hashtableStats(HashTable hashtable){
+    hashtableRehashStep(hashtable, SIZE_MAX);
+    HashTableStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.sizeTable = hashtable.sizeTable;
+    stats.numberOfPairs = hashtable.numberOfPairs;
+    stats.nbResizes = hashtable.nbResizes;
+    stats.resizeTime = hashtable.resizeTime;
+    size_t sumPositions = 0;
+    size_t sumLengths = 0;
+    for (size_t i = 0; i < hashtable.sizeTable; i++) {
+        size_t length = 0;
+        for (Cell *cell = hashtable.table[i]; cell != NULL; cell = cell->nextCell) {
+            length++;
+            // the k-th cell of a list is found after k probes
+            sumPositions += length;
+            stats.bytesCells += sizeof(Cell);
+            if (hashtableHasInlineKey(hashtable, cell)) {
+                stats.bytesCells += cell->sizeKey + 1;
+            }
+            else {
+                stats.bytesKeys += cell->sizeKey + 1;
+            }
+        }
+        // a missing key is compared to all the cells of its list
+        sumLengths += length;
+        stats.lengths[length < HASHTABLE_STATS_NB_LENGTHS ? length : HASHTABLE_STATS_NB_LENGTHS - 1]++;
+        if (length > stats.maxLength) {
+            stats.maxLength = length;
+        }
     }
-    HashTable table = hashtableCreate(4);
-    char word[100];
-    while (fscanf(file, "%s", word) != EOF) {
-        char *key=malloc((strlen(word)+1)*sizeof(char));
-        strcpy(key,word);
-        if (hashtableHasKey(table, key)) {
-            hashtableInsert(&table, key, hashtableGetValue(table, key) + 1);
-        } else {
-            hashtableInsert(&table, key, 1);
-        }
-    }
-    printf("Number of words: %lli\n", SumofValues(table));
-    printf("Number of distinct words: %lli\n", NumberofCellules(table));
-    fclose(file);
-    hashtableDestroy(&table);
-    return;
+    stats.bloomFalsePositiveRate = hashtableBloomFalsePositiveRate(hashtable);
+    if (hashtable.numberOfPairs > 0) {
+        stats.expectedProbesSuccessful = (double)sumPositions / hashtable.numberOfPairs;
+    }
+    if (hashtable.sizeTable > 0) {
+        stats.expectedProbesUnsuccessful = (double)sumLengths / hashtable.sizeTable;
+        if (hashtable.bloom != NULL) {
+            stats.expectedProbesUnsuccessful *= stats.bloomFalsePositiveRate;
+        }
+    }
+
+    stats.bytesTable = hashtable.sizeTable * sizeof(List);
+    if (hashtable.arena != NULL) {
+        // the keys are in the chunks with the cells
+        stats.bytesCells = 0;
+        for (HashTableArenaChunk *chunk = hashtable.arena->chunks; chunk != NULL; chunk = chunk->nextChunk) {
+            stats.bytesCells += sizeof(HashTableArenaChunk) + chunk->size;
+        }
+        stats.bytesKeys = 0;
+    }
+    if (hashtable.bloom != NULL) {
+        stats.bytesBloom = hashtable.bloom->nbBlocks * BLOOM_BLOCK_WORDS * sizeof(uint64_t);
+    }
+    stats.bytesTotal = stats.bytesTable + stats.bytesCells + stats.bytesKeys + stats.bytesBloom;
+    if (hashtable.counters != NULL) {
+        stats.counters = *hashtable.counters;
+    }
+    return stats;
+}
+
+/**
+ * @brief Prints the statistics of a hash table
+ *
+ * @param stats the statistics given by hashtableStats
+ */
+void hashtableStatsPrint(HashTableStats stats){
+    printf("---Hash Table statistics:\n");
+    printf("Size: %zu, number of pairs: %zu, load factor: %.2f\n", stats.sizeTable, stats.numberOfPairs,
+           stats.sizeTable > 0 ? (double)stats.numberOfPairs / stats.sizeTable : 0.0);
+    printf("Lengths of the lists:");
+    for (int i = 0; i < HASHTABLE_STATS_NB_LENGTHS; i++) {
+        if (stats.lengths[i] > 0) {
+            printf(" %d%s:%zu", i, i == HASHTABLE_STATS_NB_LENGTHS - 1 ? "+" : "", stats.lengths[i]);
+        }
+    }
+    printf("\nLongest list: %zu\n", stats.maxLength);
+    printf("Expected probes: %.3f (successful lookup), %.3f (unsuccessful lookup)\n",
+           stats.expectedProbesSuccessful, stats.expectedProbesUnsuccessful);
+    printf("Resizes: %zu in %f s\n", stats.nbResizes, stats.resizeTime);
+    printf("Bytes: %zu (table %zu, cells %zu, keys %zu, Bloom filter %zu), %.1f per pair\n",
+           stats.bytesTotal, stats.bytesTable, stats.bytesCells, stats.bytesKeys, stats.bytesBloom,
+           stats.numberOfPairs > 0 ? (double)stats.bytesTotal / stats.numberOfPairs : 0.0);
+    if (stats.bloomFalsePositiveRate >= 0) {
+        printf("Bloom filter false positive rate: %f\n", stats.bloomFalsePositiveRate);
+    }
+    HashTableCounters counters = stats.counters;
+    if (counters.nbHits + counters.nbMisses > 0) {
+        printf("Counted lookups: %zu hits (%.3f probes), %zu misses (%.3f probes, %zu rejected by the filter), max %zu probes\n",
+               counters.nbHits, counters.nbHits > 0 ? (double)counters.nbProbesHit / counters.nbHits : 0.0,
+               counters.nbMisses, counters.nbMisses > 0 ? (double)counters.nbProbesMiss / counters.nbMisses : 0.0,
+               counters.nbBloomRejections, counters.maxProbes);
+    }
+    printf("---\n");
 }
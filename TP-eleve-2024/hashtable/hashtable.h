@@ -13,21 +13,232 @@
 #ifndef HASHTABLE_H_INCLUDED
 #define HASHTABLE_H_INCLUDED
 
+#include <stdint.h>
 #include "../list/list.h"
 
+/**
+ * @brief Number of buckets of the old table moved at each operation
+ * during an incremental resizing
+ */
+#define HASHTABLE_REHASH_STEP 4
+
+/**
+ * @brief Number of keys whose lookups are interleaved by hashtableGetValues
+ */
+#define HASHTABLE_BATCH_SIZE 16
+
+/**
+ * @brief Default maximal load factor: the table grows when it has
+ * as many pairs as lists
+ */
+#define HASHTABLE_MAX_LOAD_FACTOR 1.0
+
+/**
+ * @brief Default minimal load factor: 0, the table never shrinks
+ */
+#define HASHTABLE_MIN_LOAD_FACTOR 0.0
+
+/**
+ * @brief State of an incremental resizing
+ *
+ * During an incremental resizing, the pairs are spread over the old
+ * table [oldTable] of size [sizeOldTable] and the new table of the hash
+ * table. The buckets of the old table are moved one after the other,
+ * [nextBucket] being the first bucket that has not been moved yet.
+ * The structure is allocated on the heap so that it is shared by all
+ * the copies of the hash table (the lookups receive a copy).
+ */
+typedef struct hashtableResize{
+    List *oldTable; /**< Table being emptied, NULL if no resizing is in progress */
+    size_t sizeOldTable; /**< Size of the old table */
+    size_t nextBucket; /**< First bucket of the old table not yet moved */
+} HashTableResize;
+
+/**
+ * @brief Number of bits of a Bloom filter for each bucket of the table
+ */
+#define HASHTABLE_BLOOM_BITS_PER_BUCKET 12
+
+/**
+ * @brief Number of bits set in a Bloom filter for each key
+ */
+#define HASHTABLE_BLOOM_NB_HASHES 6
+
+/**
+ * @brief Definition of a blocked Bloom filter
+ *
+ * The filter is an array of [nbBlocks] blocks of 512 bits, each of them
+ * aligned on a cache line. The hash code of a key selects a block, and
+ * HASHTABLE_BLOOM_NB_HASHES bits of this block: a key whose bits are not
+ * all set is not in the hash table, which is known from a single cache line.
+ * The removed keys cannot be taken out of the filter, they are forgotten
+ * when the filter is rebuilt after a resizing.
+ * During an incremental resizing, the filter [next] of the new table is
+ * filled with the moved pairs and the new pairs, and replaces the filter
+ * when the resizing ends.
+ */
+typedef struct hashtableBloom{
+    uint64_t *blocks; /**< Blocks of the filter */
+    size_t nbBlocks; /**< Number of blocks */
+    size_t nbKeys; /**< Number of keys added, removed keys included */
+    struct hashtableBloom *next; /**< Filter being built during an incremental resizing, NULL otherwise */
+} HashTableBloom;
+
+/**
+ * @brief Counters of the lookups of a hash table
+ *
+ * The counters are only updated when hashtable.c is compiled with
+ * -DHASHTABLE_COUNTERS, so that the lookups do not pay for them otherwise.
+ */
+typedef struct hashtableCounters{
+    size_t nbHits; /**< Number of searches (lookups and insertions) of keys in the table */
+    size_t nbMisses; /**< Number of searches of keys not in the table */
+    size_t nbProbesHit; /**< Number of cells compared by the searches of keys in the table */
+    size_t nbProbesMiss; /**< Number of cells compared by the searches of keys not in the table */
+    size_t maxProbes; /**< Maximal number of cells compared by a search */
+    size_t nbBloomRejections; /**< Number of searches answered by the Bloom filter */
+} HashTableCounters;
+
+/**
+ * @brief Type of the hash functions that can be chosen for a hash table
+ *
+ * A hash function returns the full hash code of a key given with its
+ * length. The hash table keeps the low 32 bits of the hash code.
+ */
+typedef uint64_t (*HashFunction)(string key, size_t sizeKey);
+
+/**
+ * @brief Type of the functions that combine the values of a key present
+ * in both hash tables of a merge
+ *
+ * The function receives the value of the destination and the value of
+ * the source, and returns the value kept in the destination.
+ */
+typedef int (*CombineFunction)(int valueDestination, int valueSource);
+
+/**
+ * @brief Default size of the chunks of a key arena
+ */
+#define HASHTABLE_ARENA_CHUNK_SIZE 65536
+
+/**
+ * @brief Maximal length of the keys allocated with their cell in a hash
+ * table with inline keys
+ *
+ * A cell and an inline key of this length (and its NUL character)
+ * take 64 bytes, the size of a cache line.
+ */
+#define HASHTABLE_INLINE_KEY_SIZE 31
+
+/**
+ * @brief Definition of a chunk of a key arena
+ *
+ * The chunk is allocated with its [size] bytes of data right after the
+ * structure, [used] of them being already given.
+ */
+typedef struct hashtableArenaChunk{
+    struct hashtableArenaChunk *nextChunk; /**< Previously allocated chunk */
+    size_t size; /**< Number of bytes of data of the chunk */
+    size_t used; /**< Number of bytes already given */
+} HashTableArenaChunk;
+
+/**
+ * @brief Definition of a key arena
+ *
+ * The cells and the keys of a hash table with an arena are not allocated
+ * one by one: they are taken one after the other in large chunks, which
+ * are freed all at once when the hash table is destroyed.
+ */
+typedef struct hashtableArena{
+    HashTableArenaChunk *chunks; /**< Last allocated chunk, linked to the previous ones */
+    size_t nbChunks; /**< Number of chunks */
+} HashTableArena;
+
 /**
  * @brief Definition of a hash table data structure
  *
  * The structure contains the size of the table of list [sizeTable], the number of pairs
  * (key,value)  stored in the hash table [numberOfPairs], dans
  * the table of List of pairs [table].
+ * The field [resize] is NULL when the table is resized at once,
+ * otherwise it stores the state of the incremental resizing.
+ * The field [arena] is NULL when the cells and the keys are allocated
+ * one by one, otherwise it is the arena that contains them.
+ * The field [inlineKeys] is 1 when a key of at most HASHTABLE_INLINE_KEY_SIZE
+ * characters is allocated with its cell, right after the structure, 0 otherwise.
+ * The field [hashFunction] is NULL when the keys are hashed with
+ * murmurhash32, otherwise it is the hash function of the table.
+ * When [sizeTable] is a power of two, the bucket of a key is selected
+ * with a mask instead of a division.
+ * The field [bloom] is NULL when the hash table has no Bloom filter.
+ * The fields [nbResizes] and [resizeTime] count the resizings of the table
+ * and the time they took, [counters] is NULL unless hashtable.c is
+ * compiled with -DHASHTABLE_COUNTERS.
+ * The table doubles its size when an insertion reaches [maxLoadFactor]
+ * pairs per list, and halves its size when a removal leaves less than
+ * [minLoadFactor] pairs per list.
  */
 typedef struct hashtable{
     size_t sizeTable;
     size_t numberOfPairs;
     List *table;
+    HashTableResize *resize;
+    HashTableArena *arena;
+    int inlineKeys;
+    HashFunction hashFunction;
+    HashTableBloom *bloom;
+    size_t nbResizes;
+    double resizeTime;
+    HashTableCounters *counters;
+    double maxLoadFactor;
+    double minLoadFactor;
 } HashTable;
 
+/**
+ * @brief Number of elements of the histogram of the lengths of the lists,
+ * the last one counting the lists of at least this length minus one
+ */
+#define HASHTABLE_STATS_NB_LENGTHS 16
+
+/**
+ * @brief Statistics of a hash table
+ *
+ * The probes are the cells compared by a lookup. Without counters, they
+ * are computed from the lists: a successful lookup of the k-th key of a
+ * list compares k cells, an unsuccessful lookup compares all the cells
+ * of its list (none if the Bloom filter rejects it, the mean length is
+ * then multiplied by the false positive rate of the filter).
+ */
+typedef struct hashtableStats{
+    size_t sizeTable; /**< Size of the table */
+    size_t numberOfPairs; /**< Number of pairs */
+    size_t lengths[HASHTABLE_STATS_NB_LENGTHS]; /**< Number of lists of each length */
+    size_t maxLength; /**< Length of the longest list */
+    double expectedProbesSuccessful; /**< Expected number of probes of a successful lookup: mean position of the keys in their list */
+    double expectedProbesUnsuccessful; /**< Expected number of probes of an unsuccessful lookup: mean length of the lists */
+    size_t nbResizes; /**< Number of resizings of the table */
+    double resizeTime; /**< Time spent in the resizings of the table, in seconds */
+    size_t bytesTable; /**< Bytes of the table of lists */
+    size_t bytesCells; /**< Bytes of the cells and of their inline keys (of the chunks of the arena, if any) */
+    size_t bytesKeys; /**< Bytes of the keys allocated on their own */
+    size_t bytesBloom; /**< Bytes of the Bloom filter */
+    size_t bytesTotal; /**< Bytes used by the hash table */
+    double bloomFalsePositiveRate; /**< Estimated false positive rate of the Bloom filter, -1 without filter */
+    HashTableCounters counters; /**< Counters of the lookups, all zero without -DHASHTABLE_COUNTERS */
+} HashTableStats;
+
+/**
+ * @brief Hash function murmurhash, full 32-bit version
+ *
+ * Contrary to murmurhash, the hash code is not reduced, so that
+ * it can be stored and reused by the callers.
+ *
+ * @param key string representing the key to hash
+ * @param sizeKey length of the string key
+ * @return the 32-bit hash code of the key
+ */
+uint32_t murmurhash32(string key, size_t sizeKey);
+
 /**
  * @brief Hash function murmurhash
  *
@@ -38,6 +249,17 @@ typedef struct hashtable{
  */
 size_t murmurhash(string key, size_t sizeKey, size_t maxValue);
 
+/**
+ * Returns the hash code of a key with the hash function of a hash table,
+ * to give to the ...Hash functions when the caller also needs it.
+ *
+ * @param hashtable the hash table
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the hash code of the key
+ */
+uint32_t hashtableHashKey(HashTable hashtable, string key, size_t sizeKey);
+
 
 /**
  * Create a new hash table with the given size.
@@ -47,6 +269,132 @@ size_t murmurhash(string key, size_t sizeKey, size_t maxValue);
  */
 HashTable hashtableCreate(size_t sizeTable);
 
+/**
+ * Create a new hash table with the given size, whose cells and keys
+ * are allocated in an arena.
+ *
+ * Each new pair takes its cell and a copy of its key in large chunks
+ * instead of two allocations. The memory of a removed pair is only
+ * given back when the hash table is destroyed, which then frees the
+ * chunks without visiting the pairs. It suits the tables that are
+ * filled and then destroyed, with few removals.
+ *
+ * @param sizeTable the size of the table
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithArena(size_t sizeTable);
+
+/**
+ * Create a new hash table with the given size, whose short keys are
+ * allocated with their cell.
+ *
+ * A key of at most HASHTABLE_INLINE_KEY_SIZE characters is stored right
+ * after its cell, in the same allocation: a pair takes one allocation
+ * instead of two, and a lookup compares the key in the memory of the
+ * cell it has just read. The lists of such a hash table are freed by the
+ * hash table only, never with freeList.
+ *
+ * @param sizeTable the size of the table
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithInlineKeys(size_t sizeTable);
+
+/**
+ * Create a new hash table whose keys are hashed with the given function.
+ *
+ * The size is rounded up to a power of two and stays a power of two
+ * when the table grows, so that the bucket of a key is selected with
+ * a mask of the hash code.
+ *
+ * @param sizeTable the minimal size of the table
+ * @param hashFunction the hash function, NULL for murmurhash32
+ * @return an empty hash table with the convenient table size
+ */
+HashTable hashtableCreateWithHash(size_t sizeTable, HashFunction hashFunction);
+
+/**
+ * Change the hash function of a hash table. The pairs already in the
+ * hash table are hashed again with the new function.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param hashFunction the hash function, NULL for murmurhash32
+ */
+void hashtableSetHashFunction(HashTable *hashtable, HashFunction hashFunction);
+
+/**
+ * Add or remove the Bloom filter of the hash table.
+ *
+ * With a Bloom filter, a lookup of a key that is not in the hash table
+ * is usually answered by the filter, without reading the bucket of the
+ * key. The filter is updated by the insertions and rebuilt when the table
+ * grows, with about HASHTABLE_BLOOM_BITS_PER_BUCKET bits per bucket.
+ * A resizing in progress is finished when the filter is added.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param enabled 1 to add the Bloom filter, 0 to remove it
+ */
+void hashtableSetBloomFilter(HashTable *hashtable, int enabled);
+
+/**
+ * Estimate the false positive rate of the Bloom filter of the hash
+ * table, that is the probability that the filter does not reject a key
+ * that is not in the hash table. The estimate is computed from the
+ * number of bits set in each block.
+ *
+ * @param hashtable the hash table
+ * @return the estimated false positive rate, -1 if the hash table has no Bloom filter
+ */
+double hashtableBloomFalsePositiveRate(HashTable hashtable);
+
+/**
+ * Enable or disable the incremental resizing of the hash table.
+ *
+ * When the incremental resizing is enabled, hashtableInsert does not
+ * move all the pairs at once when the table grows: it keeps the old
+ * and the new tables and each following insertion or removal moves at most
+ * HASHTABLE_REHASH_STEP buckets of the old table into the new one. The
+ * lookups search both tables and never move a bucket, so that they only
+ * read the hash table.
+ * The worst-case time of an insertion then stays bounded while the table grows.
+ * Disabling the incremental resizing finishes the resizing in progress.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param incremental 1 to enable the incremental resizing, 0 to disable it
+ */
+void hashtableSetIncremental(HashTable *hashtable, int incremental);
+
+/**
+ * Set the load factors of the hash table.
+ *
+ * hashtableInsert doubles the size of the table when the number of pairs
+ * reaches maxLoadFactor times the size, and hashtableRemove halves it when
+ * the number of pairs falls below minLoadFactor times the size.
+ * The minimal load factor must be at most a quarter of the maximal one:
+ * a table that has just shrunk is then at most half full, and a table
+ * that has just grown is far from shrinking, so that alternating insertions
+ * and removals do not resize the table at each operation.
+ * The size of the table is not changed by this function.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param maxLoadFactor the maximal number of pairs per list, larger than 0
+ * (HASHTABLE_MAX_LOAD_FACTOR by default)
+ * @param minLoadFactor the minimal number of pairs per list, 0 to never
+ * shrink the table (HASHTABLE_MIN_LOAD_FACTOR by default)
+ */
+void hashtableSetLoadFactors(HashTable *hashtable, double maxLoadFactor, double minLoadFactor);
+
+/**
+ * Make room for nbPairs pairs in the hash table.
+ *
+ * The size of the table is doubled until nbPairs pairs fit in it without
+ * reaching the maximal load factor, so that loading them does not resize
+ * the table again. The table is never shrunk by this function.
+ *
+ * @param hashtable pointer on the hash table, supposed to be non null
+ * @param nbPairs the number of pairs the hash table will hold
+ */
+void hashtableReserve(HashTable *hashtable, size_t nbPairs);
+
 /**
  * Free the memory used by the input hash table (given with a pointer).
  * The fields sizeTable and numberOfPairs are set to 0.
@@ -54,6 +402,7 @@ HashTable hashtableCreate(size_t sizeTable);
  * the table is set to NULL.
  * However, the memory to store the data structure is not freed.
  * It must be done outside the function.
+ * With an arena, the pairs are freed with the chunks of the arena.
  * @param hashtable hash table to free
  */
 void hashtableDestroy(HashTable *hashtable);
@@ -76,6 +425,18 @@ void hashtableDestroy(HashTable *hashtable);
  */
 void hashtableInsertWithoutResizing(HashTable *hashtable, string key, int value);
 
+/**
+ * Same as hashtableInsertWithoutResizing, for a key given with its length.
+ * The key does not need to be NUL-terminated and may contain NUL characters:
+ * the first sizeKey characters are hashed and copied, without any call to strlen.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair
+ * @param sizeKey the length of the key
+ * @param value the value for the new pair
+ */
+void hashtableInsertWithoutResizingLen(HashTable *hashtable, string key, size_t sizeKey, int value);
+
 
 /**
  * Returns a new hash table whose table size is the double
@@ -108,28 +469,183 @@ HashTable hashtableDoubleSize(HashTable hashtable);
  */
 void hashtableInsert(HashTable *hashtable, string key,  int value);
 
+/**
+ * Same as hashtableInsert, for a key given with its length
+ * (see hashtableInsertWithoutResizingLen).
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair
+ * @param sizeKey the length of the key
+ * @param value the value for the new pair
+ */
+void hashtableInsertLen(HashTable *hashtable, string key, size_t sizeKey, int value);
+
+/**
+ * Same as hashtableInsertLen, for a key whose hash code is already known.
+ *
+ * @param hashtable pointer on the hash table to insert into, supposed not to be null.
+ * @param key the key for the new pair, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @param value the value for the new pair
+ */
+void hashtableInsertHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash, int value);
+
+/**
+ * Get a pointer on the value associated with the given key, after
+ * inserting the pair (key,defaultValue) if the key is not in the hash table.
+ * The key is hashed and searched only once.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key to search for or to insert
+ * @param defaultValue the value of the new pair if the key is inserted
+ * @return a pointer on the value associated to the key, valid until the key
+ * is removed, the hash table is destroyed, or its cells are copied by
+ * hashtableDoubleSize or hashtableMerge (the automatic resizings keep it)
+ */
+int *hashtableGetOrInsert(HashTable *hashtable, string key, int defaultValue);
+
+/**
+ * Same as hashtableGetOrInsert, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key to search for or to insert, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param defaultValue the value of the new pair if the key is inserted
+ * @return a pointer on the value associated to the key, valid until the key
+ * is removed, the hash table is destroyed, or its cells are copied by
+ * hashtableDoubleSize or hashtableMerge (the automatic resizings keep it)
+ */
+int *hashtableGetOrInsertLen(HashTable *hashtable, string key, size_t sizeKey, int defaultValue);
+
+/**
+ * Add delta to the value associated with the given key. A missing
+ * key is inserted with the value delta. The key is hashed and
+ * searched only once, which suits the counting loops.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrement(HashTable *hashtable, string key, int delta);
+
+/**
+ * Same as hashtableIncrement, for a key given with its length.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrementLen(HashTable *hashtable, string key, size_t sizeKey, int delta);
+
+/**
+ * Same as hashtableIncrementLen, for a key whose hash code is already known.
+ *
+ * @param hashtable pointer on the hash table, supposed not to be null.
+ * @param key the key whose value is incremented, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int hashtableIncrementHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash, int delta);
+
 /**
  * Test if a key is in the hash table.
+ * The hash table is only read, even during an incremental resizing.
  * @param hashtable the hash table to search in, supposed to be non null
  * @param key the key to search for
  * @return 1 if the key is in the table, 0 otherwise.
  */
 int hashtableHasKey(HashTable hashtable, string key);
 
+/**
+ * Same as hashtableHasKey, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int hashtableHasKeyLen(HashTable hashtable, string key, size_t sizeKey);
+
+/**
+ * Same as hashtableHasKeyLen, for a key whose hash code is already known.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int hashtableHasKeyHash(HashTable hashtable, string key, size_t sizeKey, uint32_t hash);
+
 
 /**
  * Get the value associated with the given key.
  * The key is supposed to be in the hash table.
+ * The hash table is only read, even during an incremental resizing.
  * @param hashtable the hash table to search in
  * @param key the key to search for
  * @return the value associated to the key
  */
 int hashtableGetValue(HashTable hashtable, string key);
 
+/**
+ * Same as hashtableGetValue, for a key given with its length.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int hashtableGetValueLen(HashTable hashtable, string key, size_t sizeKey);
+
+/**
+ * Same as hashtableGetValueLen, for a key whose hash code is already known.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int hashtableGetValueHash(HashTable hashtable, string key, size_t sizeKey, uint32_t hash);
 
 /**
- * Remove the key-value pair with the given key from the hash table.
+ * Get the values associated with several keys.
  *
+ * The keys are looked up by groups of HASHTABLE_BATCH_SIZE: the keys of a
+ * group are hashed and their buckets prefetched, then the first cells of
+ * the buckets are prefetched, then their keys, and only then the keys are
+ * compared. The memory accesses of the keys of a group overlap instead of
+ * waiting for each other, which is faster than hashtableGetValue for
+ * large tables that do not fit in the cache.
+ *
+ * @param hashtable the hash table to search in
+ * @param keys array of the nbKeys keys to search for
+ * @param nbKeys the number of keys
+ * @param values array that receives the nbKeys values, -1 for the keys
+ * that are not in the table
+ */
+void hashtableGetValues(HashTable hashtable, string *keys, size_t nbKeys, int *values);
+
+/**
+ * Same as hashtableGetValues, for keys given with their lengths.
+ *
+ * @param hashtable the hash table to search in
+ * @param keys array of the nbKeys keys to search for, not necessarily NUL-terminated
+ * @param sizeKeys array of the lengths of the keys
+ * @param nbKeys the number of keys
+ * @param values array that receives the nbKeys values, -1 for the keys
+ * that are not in the table
+ */
+void hashtableGetValuesLen(HashTable hashtable, string *keys, size_t *sizeKeys, size_t nbKeys, int *values);
+
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ * The size of the table is halved if less than minLoadFactor pairs per
+ * list remain (never with the default load factors).
  *
  * @param hashtable the hash table to remove from
  * @param key the key of the pair to remove
@@ -138,18 +654,52 @@ int hashtableGetValue(HashTable hashtable, string key);
 int hashtableRemove(HashTable *hashtable, string key);
 
 /**
- * @brief Prints the contents of a hash table
+ * Same as hashtableRemove, for a key given with its length.
  *
- * @param hashtable Hash table to be printed
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return 0 if the key was not in the hash table, 1 otherwise
  */
-void hashtablePrint(HashTable hashtable) ;
+int hashtableRemoveLen(HashTable *hashtable, string key, size_t sizeKey);
+
+/**
+ * Same as hashtableRemoveLen, for a key whose hash code is already known.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param hash the hash code of the key, given by hashtableHashKey
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int hashtableRemoveHash(HashTable *hashtable, string key, size_t sizeKey, uint32_t hash);
 
 /**
- * Prints the number of words and distinct words in the file
- * "potter-clean.txt"
+ * Move all the pairs of a hash table into another one.
+ *
+ * The destination is first resized once to hold the pairs of both tables.
+ * A key of the source that is not in the destination keeps its cell and its
+ * key, which are linked into the destination without any allocation (their
+ * hash code is reused if both tables have the same hash function). The
+ * cells are copied only when one table has an arena and the other has
+ * not; when both have one, the chunks of the source are given to the
+ * destination. The value of a key present in both tables is
+ * combine(value in destination, value in source).
  *
+ * @param destination pointer on the hash table that receives the pairs
+ * @param source pointer on the hash table whose pairs are moved, destroyed
+ * by the merge as by hashtableDestroy
+ * @param combine the function combining the values of a key present in
+ * both tables, NULL to keep the value of the source
  */
-void countDistinctWordsInBook();
+void hashtableMerge(HashTable *destination, HashTable *source, CombineFunction combine);
+
+/**
+ * @brief Prints the contents of a hash table
+ *
+ * @param hashtable Hash table to be printed
+ */
+void hashtablePrint(HashTable hashtable) ;
 
 /**
  * @brief Returns the number of cells in the hash table
@@ -167,4 +717,22 @@ long long int NumberofCellules(HashTable hashtable);
  */
 long long int SumofValues(HashTable hashtable);
 
+/**
+ * @brief Returns the statistics of the hash table
+ *
+ * The table is traversed, after the end of the resizing in progress if any:
+ * unlike the lookups, it modifies the hash table.
+ *
+ * @param hashtable the hash table
+ * @return the statistics of the hash table
+ */
+HashTableStats hashtableStats(HashTable hashtable);
+
+/**
+ * @brief Prints the statistics of a hash table
+ *
+ * @param stats the statistics given by hashtableStats
+ */
+void hashtableStatsPrint(HashTableStats stats);
+
 #endif // HASHTABLE_H_INCLUDED
@@ -0,0 +1,267 @@
+/**
+ * @file openhashtable.c
+ * @brief Source file for a hash table implementation based on open addressing
+ *
+ * This file contains the implementation of the open addressing hash table
+ * (Robin Hood hashing). Each pair is stored in the slot array with its full
+ * hash code, so that a lookup only compares strings when the hash codes are
+ * equal, and the resizing never hashes the keys again.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "openhashtable.h"
+#include "hashtable.h"
+
+/**
+ * @brief Minimal size of a non empty table of slots
+ */
+#define OPEN_HASHTABLE_MIN_SIZE 8
+
+/**
+ * @brief Returns the smallest power of two greater or equal to n (and to the minimal size)
+ */
+static size_t nextPowerOfTwo(size_t n) {
+    size_t size = OPEN_HASHTABLE_MIN_SIZE;
+    while (size < n) {
+        size *= 2;
+    }
+    return size;
+}
+
+/**
+ * @brief Allocates an array of size empty slots
+ */
+static OpenSlot *allocateSlots(size_t size) {
+    OpenSlot *slots = (OpenSlot *)malloc(size * sizeof(OpenSlot));
+    for (size_t i = 0; i < size; i++) {
+        slots[i].key = NULL;
+        slots[i].distance = 0;
+    }
+    return slots;
+}
+
+/**
+ * @brief Places a slot that is not yet in the table (Robin Hood insertion)
+ *
+ * The slot to place goes forward from its ideal position and takes the place
+ * of any slot that is closer to its own ideal position. The displaced slot is
+ * then placed in the same way. The table is supposed to have a free slot.
+ *
+ * @param hashtable hash table to insert into
+ * @param slot slot to place, the field distance is ignored
+ */
+static void placeSlot(OpenHashTable *hashtable, OpenSlot slot) {
+    size_t mask = hashtable->sizeTable - 1;
+    size_t index = slot.hash & mask;
+    slot.distance = 1;
+    while (hashtable->slots[index].distance != 0) {
+        if (hashtable->slots[index].distance < slot.distance) {
+            OpenSlot temp = hashtable->slots[index];
+            hashtable->slots[index] = slot;
+            slot = temp;
+        }
+        index = (index + 1) & mask;
+        slot.distance++;
+    }
+    hashtable->slots[index] = slot;
+}
+
+/**
+ * @brief Replaces the table of slots by a new one of the given size
+ *
+ * The pairs are moved without hashing or copying the keys again.
+ */
+static void resizeSlots(OpenHashTable *hashtable, size_t newSize) {
+    OpenSlot *oldSlots = hashtable->slots;
+    size_t oldSize = hashtable->sizeTable;
+    hashtable->slots = allocateSlots(newSize);
+    hashtable->sizeTable = newSize;
+    for (size_t i = 0; i < oldSize; i++) {
+        if (oldSlots[i].distance != 0) {
+            placeSlot(hashtable, oldSlots[i]);
+        }
+    }
+    free(oldSlots);
+}
+
+/**
+ * @brief Finds the index of the slot that contains the key
+ *
+ * The search stops as soon as a slot is closer to its ideal position than
+ * the key would be, since the key would have taken this slot.
+ *
+ * @return the index of the slot, or -1 if the key is not in the table
+ */
+static long findSlot(OpenHashTable hashtable, string key, uint32_t hash) {
+    if (hashtable.sizeTable == 0) {
+        return -1;
+    }
+    size_t mask = hashtable.sizeTable - 1;
+    size_t index = hash & mask;
+    uint32_t distance = 1;
+    while (hashtable.slots[index].distance >= distance) {
+        if (hashtable.slots[index].hash == hash && strcmp(hashtable.slots[index].key, key) == 0) {
+            return (long)index;
+        }
+        index = (index + 1) & mask;
+        distance++;
+    }
+    return -1;
+}
+
+
+/**
+ * Create a new open addressing hash table.
+ *
+ * @param sizeTable the minimal size of the table, rounded up to a power of two
+ * @return an empty hash table with the convenient table size
+ */
+OpenHashTable openHashtableCreate(size_t sizeTable) {
+    OpenHashTable hashtable;
+    hashtable.numberOfPairs = 0;
+    if (sizeTable > 0) {
+        hashtable.sizeTable = nextPowerOfTwo(sizeTable);
+        hashtable.slots = allocateSlots(hashtable.sizeTable);
+    } else {
+        hashtable.sizeTable = 0;
+        hashtable.slots = NULL;
+    }
+    return hashtable;
+}
+
+
+/**
+ * Free the memory used by the input hash table (given with a pointer).
+ * The fields sizeTable and numberOfPairs are set to 0 and
+ * the table of slots is set to NULL.
+ * @param hashtable hash table to free
+ */
+void openHashtableDestroy(OpenHashTable *hashtable) {
+    for (size_t i = 0; i < hashtable->sizeTable; i++) {
+        if (hashtable->slots[i].distance != 0) {
+            free(hashtable->slots[i].key);
+        }
+    }
+    free(hashtable->slots);
+    hashtable->sizeTable = 0;
+    hashtable->numberOfPairs = 0;
+    hashtable->slots = NULL;
+}
+
+
+/**
+ * Insert a new key-value pair into the hash table. The table
+ * is resized if necessary (load factor greater than 7/8). If the key is
+ * already in the hash table, the old value is replaced by the input value.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair (copied in the table)
+ * @param value the value for the new pair
+ */
+void openHashtableInsert(OpenHashTable *hashtable, string key, int value) {
+    size_t sizeKey = strlen(key);
+    uint32_t hash = murmurhash32(key, sizeKey);
+    long index = findSlot(*hashtable, key, hash);
+    if (index >= 0) {
+        hashtable->slots[index].value = value;
+        return;
+    }
+    if (8 * (hashtable->numberOfPairs + 1) > 7 * hashtable->sizeTable) {
+        resizeSlots(hashtable, nextPowerOfTwo(2 * hashtable->sizeTable));
+    }
+    OpenSlot slot;
+    slot.key = (string)malloc((sizeKey + 1) * sizeof(char));
+    memcpy(slot.key, key, sizeKey + 1);
+    slot.hash = hash;
+    slot.value = value;
+    placeSlot(hashtable, slot);
+    hashtable->numberOfPairs++;
+}
+
+
+/**
+ * Test if a key is in the hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int openHashtableHasKey(OpenHashTable hashtable, string key) {
+    if (findSlot(hashtable, key, murmurhash32(key, strlen(key))) >= 0) {
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int openHashtableGetValue(OpenHashTable hashtable, string key) {
+    long index = findSlot(hashtable, key, murmurhash32(key, strlen(key)));
+    if (index >= 0) {
+        return hashtable.slots[index].value;
+    }
+    return -1;
+}
+
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ * The following slots of the cluster are shifted backward, so that
+ * no tombstone is needed.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int openHashtableRemove(OpenHashTable *hashtable, string key) {
+    long found = findSlot(*hashtable, key, murmurhash32(key, strlen(key)));
+    if (found < 0) {
+        return 0;
+    }
+    size_t mask = hashtable->sizeTable - 1;
+    size_t index = (size_t)found;
+    free(hashtable->slots[index].key);
+    size_t next = (index + 1) & mask;
+    while (hashtable->slots[next].distance > 1) {
+        hashtable->slots[index] = hashtable->slots[next];
+        hashtable->slots[index].distance--;
+        index = next;
+        next = (next + 1) & mask;
+    }
+    hashtable->slots[index].key = NULL;
+    hashtable->slots[index].distance = 0;
+    hashtable->numberOfPairs--;
+    return 1;
+}
+
+
+/**
+ * @brief Prints the contents of an open addressing hash table
+ *
+ * @param hashtable Hash table to be printed
+ */
+void openHashtablePrint(OpenHashTable hashtable) {
+    printf("---Open Hash Table:\n");
+    printf("Size: %zu\n", hashtable.sizeTable);
+    printf("Number of Pairs: %zu\n", hashtable.numberOfPairs);
+    if (hashtable.slots != NULL) {
+        for (size_t i = 0; i < hashtable.sizeTable; i++) {
+            if (hashtable.slots[i].distance != 0) {
+                printf("%zu: (%s,%d) distance %u\n", i, hashtable.slots[i].key,
+                       hashtable.slots[i].value, hashtable.slots[i].distance - 1);
+            }
+        }
+    }
+    else
+        printf("NULL table\n");
+    printf("---\n");
+}
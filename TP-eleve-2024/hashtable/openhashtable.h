@@ -0,0 +1,108 @@
+/**
+ * @file openhashtable.h
+ * @brief Header file for a hash table implementation based on open addressing
+ *
+ * This file contains the declaration of an open addressing hash table
+ * (Robin Hood hashing with backward shift deletion) and its associated
+ * functions. It offers the same operations as the hash table based on
+ * linked lists (hashtable.h), but all the pairs are stored in a single
+ * contiguous array of slots, so that a lookup reads consecutive slots
+ * instead of following the cells of a list.
+ */
+
+
+#ifndef OPENHASHTABLE_H_INCLUDED
+#define OPENHASHTABLE_H_INCLUDED
+
+#include <stdint.h>
+#include "../list/list.h"
+
+/**
+ * @brief Definition of a slot of an open addressing hash table
+ *
+ * The slot contains the key (a string), the value (an integer),
+ * the full 32-bit hash code of the key [hash] and the distance
+ * of the slot from the ideal slot of the key plus one [distance].
+ * A distance equal to 0 means that the slot is empty.
+ */
+typedef struct openSlot{
+    string key; /**< Key of the slot */
+    uint32_t hash; /**< Full hash code of the key */
+    uint32_t distance; /**< Probe distance plus one, 0 for an empty slot */
+    int value; /**< Value of the slot */
+} OpenSlot;
+
+/**
+ * @brief Definition of an open addressing hash table
+ *
+ * The structure contains the size of the table of slots [sizeTable],
+ * always a power of two, the number of pairs (key,value) stored in
+ * the hash table [numberOfPairs] and the table of slots [slots].
+ */
+typedef struct openHashtable{
+    size_t sizeTable;
+    size_t numberOfPairs;
+    OpenSlot *slots;
+} OpenHashTable;
+
+
+/**
+ * Create a new open addressing hash table.
+ *
+ * @param sizeTable the minimal size of the table, rounded up to a power of two
+ * @return an empty hash table with the convenient table size
+ */
+OpenHashTable openHashtableCreate(size_t sizeTable);
+
+/**
+ * Free the memory used by the input hash table (given with a pointer).
+ * The fields sizeTable and numberOfPairs are set to 0 and
+ * the table of slots is set to NULL.
+ * @param hashtable hash table to free
+ */
+void openHashtableDestroy(OpenHashTable *hashtable);
+
+/**
+ * Insert a new key-value pair into the hash table. The table
+ * is resized if necessary. If the key is already in the hash table,
+ * the old value is replaced by the input value.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair (copied in the table)
+ * @param value the value for the new pair
+ */
+void openHashtableInsert(OpenHashTable *hashtable, string key, int value);
+
+/**
+ * Test if a key is in the hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int openHashtableHasKey(OpenHashTable hashtable, string key);
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int openHashtableGetValue(OpenHashTable hashtable, string key);
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int openHashtableRemove(OpenHashTable *hashtable, string key);
+
+/**
+ * @brief Prints the contents of an open addressing hash table
+ *
+ * @param hashtable Hash table to be printed
+ */
+void openHashtablePrint(OpenHashTable hashtable);
+
+#endif // OPENHASHTABLE_H_INCLUDED
@@ -0,0 +1,194 @@
+/**
+ * @file shardedhashtable.c
+ * @brief Source file for a thread-safe hash table split into shards
+ *
+ * Each operation hashes the key outside of any lock to find its shard,
+ * then runs the usual operation of hashtable.c on this shard while
+ * holding the lock of the shard only. The length and the hash code of
+ * the key are given to the ...Hash operations, so that the key is
+ * measured and hashed only once.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "shardedhashtable.h"
+#include "hashtable.h"
+
+/**
+ * @brief Maximal number of shards
+ */
+#define MAX_SHARDS 65536
+
+/**
+ * @brief Returns the shard of a key
+ *
+ * The high bits of the hash code select the shard, so that the low bits
+ * used by the shard to select a bucket remain evenly distributed.
+ *
+ * @param hashtable the sharded hash table
+ * @param key the key
+ * @param sizeKey receives the length of the key
+ * @param hash receives the hash code of the key, the same for all the shards
+ * @return the shard of the key
+ */
+static HashTableShard *findShard(ShardedHashTable hashtable, string key, size_t *sizeKey, uint32_t *hash) {
+    *sizeKey = strlen(key);
+    *hash = hashtableHashKey(hashtable.shards[0].hashtable, key, *sizeKey);
+    if (hashtable.nbShards == 1) {
+        return hashtable.shards;
+    }
+    int nbBits = __builtin_ctzl(hashtable.nbShards);
+    return &hashtable.shards[*hash >> (32 - nbBits)];
+}
+
+
+/**
+ * Create a new sharded hash table.
+ *
+ * @param nbShards the number of shards, rounded up to a power of two
+ * @param sizeTable the initial size of the table, shared between the shards
+ * @return an empty sharded hash table
+ */
+ShardedHashTable shardedHashtableCreate(size_t nbShards, size_t sizeTable) {
+    ShardedHashTable hashtable;
+    hashtable.nbShards = 1;
+    while (hashtable.nbShards < nbShards && hashtable.nbShards < MAX_SHARDS) {
+        hashtable.nbShards *= 2;
+    }
+    size_t sizeShard = sizeTable / hashtable.nbShards;
+    if (sizeShard == 0) {
+        sizeShard = 1;
+    }
+    hashtable.shards = (HashTableShard *)aligned_alloc(SHARD_ALIGNMENT, hashtable.nbShards * sizeof(HashTableShard));
+    for (size_t i = 0; i < hashtable.nbShards; i++) {
+        pthread_mutex_init(&hashtable.shards[i].lock, NULL);
+        hashtable.shards[i].hashtable = hashtableCreate(sizeShard);
+    }
+    return hashtable;
+}
+
+
+/**
+ * Free the memory used by the sharded hash table.
+ * @param hashtable hash table to free
+ */
+void shardedHashtableDestroy(ShardedHashTable *hashtable) {
+    for (size_t i = 0; i < hashtable->nbShards; i++) {
+        hashtableDestroy(&hashtable->shards[i].hashtable);
+        pthread_mutex_destroy(&hashtable->shards[i].lock);
+    }
+    free(hashtable->shards);
+    hashtable->shards = NULL;
+    hashtable->nbShards = 0;
+}
+
+
+/**
+ * Insert a new key-value pair into the hash table, or replace
+ * the value if the key is already in the hash table.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair
+ * @param value the value for the new pair
+ */
+void shardedHashtableInsert(ShardedHashTable *hashtable, string key, int value) {
+    size_t sizeKey;
+    uint32_t hash;
+    HashTableShard *shard = findShard(*hashtable, key, &sizeKey, &hash);
+    pthread_mutex_lock(&shard->lock);
+    hashtableInsertHash(&shard->hashtable, key, sizeKey, hash, value);
+    pthread_mutex_unlock(&shard->lock);
+}
+
+
+/**
+ * Add delta to the value associated with the given key. A missing
+ * key is inserted with the value delta.
+ *
+ * @param hashtable pointer on the hash table.
+ * @param key the key whose value is incremented
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int shardedHashtableIncrement(ShardedHashTable *hashtable, string key, int delta) {
+    size_t sizeKey;
+    uint32_t hash;
+    HashTableShard *shard = findShard(*hashtable, key, &sizeKey, &hash);
+    pthread_mutex_lock(&shard->lock);
+    int value = hashtableIncrementHash(&shard->hashtable, key, sizeKey, hash, delta);
+    pthread_mutex_unlock(&shard->lock);
+    return value;
+}
+
+
+/**
+ * Test if a key is in the hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int shardedHashtableHasKey(ShardedHashTable hashtable, string key) {
+    size_t sizeKey;
+    uint32_t hash;
+    HashTableShard *shard = findShard(hashtable, key, &sizeKey, &hash);
+    pthread_mutex_lock(&shard->lock);
+    int result = hashtableHasKeyHash(shard->hashtable, key, sizeKey, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int shardedHashtableGetValue(ShardedHashTable hashtable, string key) {
+    size_t sizeKey;
+    uint32_t hash;
+    HashTableShard *shard = findShard(hashtable, key, &sizeKey, &hash);
+    pthread_mutex_lock(&shard->lock);
+    int value = hashtableGetValueHash(shard->hashtable, key, sizeKey, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return value;
+}
+
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int shardedHashtableRemove(ShardedHashTable *hashtable, string key) {
+    size_t sizeKey;
+    uint32_t hash;
+    HashTableShard *shard = findShard(*hashtable, key, &sizeKey, &hash);
+    pthread_mutex_lock(&shard->lock);
+    int result = hashtableRemoveHash(&shard->hashtable, key, sizeKey, hash);
+    pthread_mutex_unlock(&shard->lock);
+    return result;
+}
+
+
+/**
+ * Returns the number of pairs stored in the hash table.
+ * @param hashtable the hash table
+ * @return the number of pairs in all the shards
+ */
+size_t shardedHashtableNumberOfPairs(ShardedHashTable hashtable) {
+    size_t count = 0;
+    for (size_t i = 0; i < hashtable.nbShards; i++) {
+        pthread_mutex_lock(&hashtable.shards[i].lock);
+        count += hashtable.shards[i].hashtable.numberOfPairs;
+        pthread_mutex_unlock(&hashtable.shards[i].lock);
+    }
+    return count;
+}
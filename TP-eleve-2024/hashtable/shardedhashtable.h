@@ -0,0 +1,116 @@
+/**
+ * @file shardedhashtable.h
+ * @brief Header file for a thread-safe hash table split into shards
+ *
+ * This file contains the declaration of a concurrent hash table: the keys
+ * are spread over several independent hash tables (the shards), each of them
+ * protected by its own lock. Two threads working on keys of different shards
+ * never wait for each other, and each shard is resized on its own.
+ */
+
+
+#ifndef SHARDEDHASHTABLE_H_INCLUDED
+#define SHARDEDHASHTABLE_H_INCLUDED
+
+#include <pthread.h>
+#include "hashtable.h"
+
+/**
+ * @brief Alignment of the shards, so that two shards never share a cache line
+ */
+#define SHARD_ALIGNMENT 64
+
+/**
+ * @brief Definition of a shard: a hash table and the lock that protects it
+ */
+typedef struct hashtableShard{
+    _Alignas(SHARD_ALIGNMENT) pthread_mutex_t lock; /**< Lock of the shard */
+    HashTable hashtable; /**< Pairs of the shard */
+} HashTableShard;
+
+/**
+ * @brief Definition of a sharded hash table
+ *
+ * The structure contains the number of shards [nbShards], always a power
+ * of two, and the table of shards [shards]. The shard of a key is given
+ * by the high bits of its hash code, the low bits being used to select
+ * the bucket inside the shard.
+ */
+typedef struct shardedHashtable{
+    size_t nbShards;
+    HashTableShard *shards;
+} ShardedHashTable;
+
+
+/**
+ * Create a new sharded hash table.
+ *
+ * @param nbShards the number of shards, rounded up to a power of two
+ * @param sizeTable the initial size of the table, shared between the shards
+ * @return an empty sharded hash table
+ */
+ShardedHashTable shardedHashtableCreate(size_t nbShards, size_t sizeTable);
+
+/**
+ * Free the memory used by the sharded hash table. No other thread
+ * may use the hash table during and after the call.
+ * @param hashtable hash table to free
+ */
+void shardedHashtableDestroy(ShardedHashTable *hashtable);
+
+/**
+ * Insert a new key-value pair into the hash table, or replace
+ * the value if the key is already in the hash table.
+ *
+ * @param hashtable pointer on the hash table to insert into.
+ * @param key the key for the new pair
+ * @param value the value for the new pair
+ */
+void shardedHashtableInsert(ShardedHashTable *hashtable, string key, int value);
+
+/**
+ * Add delta to the value associated with the given key. A missing
+ * key is inserted with the value delta.
+ *
+ * @param hashtable pointer on the hash table.
+ * @param key the key whose value is incremented
+ * @param delta the increment
+ * @return the new value associated to the key
+ */
+int shardedHashtableIncrement(ShardedHashTable *hashtable, string key, int delta);
+
+/**
+ * Test if a key is in the hash table.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return 1 if the key is in the table, 0 otherwise.
+ */
+int shardedHashtableHasKey(ShardedHashTable hashtable, string key);
+
+/**
+ * Get the value associated with the given key.
+ * @param hashtable the hash table to search in
+ * @param key the key to search for
+ * @return the value associated to the key, -1 if the key is not in the table
+ */
+int shardedHashtableGetValue(ShardedHashTable hashtable, string key);
+
+/**
+ * Remove the key-value pair with the given key from the hash table.
+ *
+ * @param hashtable the hash table to remove from
+ * @param key the key of the pair to remove
+ * @return 0 if the key was not in the hash table, 1 otherwise
+ */
+int shardedHashtableRemove(ShardedHashTable *hashtable, string key);
+
+/**
+ * Returns the number of pairs stored in the hash table.
+ * The shards are locked one after the other, so the result is
+ * exact only if no other thread modifies the hash table.
+ * @param hashtable the hash table
+ * @return the number of pairs in all the shards
+ */
+size_t shardedHashtableNumberOfPairs(ShardedHashTable hashtable);
+
+#endif // SHARDEDHASHTABLE_H_INCLUDED
@@ -0,0 +1,236 @@
+/**
+ * @file sketch.c
+ * @brief Source file for approximate counting with a fixed memory
+ *
+ * The rows of the count-min sketch do not hash the keys again: the counter
+ * of a key in the row i is given by the first bits of h1 + i*h2, where h1
+ * and h2 are two numbers derived from the 64-bit hash code of the key
+ * (double hashing), so that a key is hashed once whatever the depth.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "sketch.h"
+#include "hashfunctions.h"
+
+
+/**
+ * Create an empty HyperLogLog.
+ *
+ * @param relativeError the wanted standard error of the estimate, for example
+ * 0.01 for 1% (16 KB). The number of registers is the smallest power of 2
+ * that gives this error, between 2^HYPERLOGLOG_MIN_PRECISION and
+ * 2^HYPERLOGLOG_MAX_PRECISION.
+ * @return the HyperLogLog, that must be destroyed by hyperLogLogDestroy
+ */
+HyperLogLog hyperLogLogCreate(double relativeError) {
+    HyperLogLog hll;
+    // the standard error is 1.04/sqrt(m) for m registers
+    int precision = HYPERLOGLOG_MIN_PRECISION;
+    while (precision < HYPERLOGLOG_MAX_PRECISION
+           && 1.04 / sqrt((double)((size_t)1 << precision)) > relativeError) {
+        precision++;
+    }
+    hll.precision = precision;
+    hll.nbRegisters = (size_t)1 << precision;
+    hll.registers = (uint8_t *)calloc(hll.nbRegisters, sizeof(uint8_t));
+    return hll;
+}
+
+/**
+ * Free the memory used by a HyperLogLog.
+ * @param hll pointer to the HyperLogLog to free
+ */
+void hyperLogLogDestroy(HyperLogLog *hll) {
+    free(hll->registers);
+    hll->registers = NULL;
+    hll->nbRegisters = 0;
+    hll->precision = 0;
+}
+
+/**
+ * Add a key to a HyperLogLog.
+ * @param hll pointer to the HyperLogLog
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ */
+void hyperLogLogAdd(HyperLogLog *hll, string key, size_t sizeKey) {
+    uint64_t hash = wyhash64(key, sizeKey);
+    size_t index = hash >> (64 - hll->precision);
+    uint64_t bits = hash << hll->precision;
+    // rank of the first 1 bit after the index, 64-precision+1 if there is none
+    uint8_t rank = bits == 0 ? 64 - hll->precision + 1 : __builtin_clzll(bits) + 1;
+    if (rank > hll->registers[index]) {
+        hll->registers[index] = rank;
+    }
+}
+
+/**
+ * Add the keys of a HyperLogLog to another one, for example to gather
+ * the counts of several threads.
+ * @param destination pointer to the HyperLogLog that receives the keys
+ * @param source HyperLogLog with the same precision
+ */
+void hyperLogLogMerge(HyperLogLog *destination, HyperLogLog source) {
+    if (destination->precision != source.precision) {
+        printf("Error:HyperLogLogs of different precisions\n");
+        return;
+    }
+    for (size_t i = 0; i < source.nbRegisters; i++) {
+        if (source.registers[i] > destination->registers[i]) {
+            destination->registers[i] = source.registers[i];
+        }
+    }
+}
+
+/**
+ * Estimate the number of distinct keys added to a HyperLogLog.
+ * @param hll the HyperLogLog
+ * @return the estimated number of distinct keys
+ */
+double hyperLogLogCount(HyperLogLog hll) {
+    double m = (double)hll.nbRegisters;
+    double sum = 0;
+    size_t nbZeros = 0;
+    for (size_t i = 0; i < hll.nbRegisters; i++) {
+        sum += 1.0 / (double)((uint64_t)1 << hll.registers[i]);
+        if (hll.registers[i] == 0) {
+            nbZeros++;
+        }
+    }
+    double alpha;
+    if (hll.nbRegisters == 16) {
+        alpha = 0.673;
+    }
+    else if (hll.nbRegisters == 32) {
+        alpha = 0.697;
+    }
+    else if (hll.nbRegisters == 64) {
+        alpha = 0.709;
+    }
+    else {
+        alpha = 0.7213 / (1 + 1.079 / m);
+    }
+    double estimate = alpha * m * m / sum;
+    // few distinct keys: linear counting on the empty registers is more precise
+    if (estimate <= 2.5 * m && nbZeros > 0) {
+        estimate = m * log(m / (double)nbZeros);
+    }
+    return estimate;
+}
+
+/**
+ * Returns the number of bytes used by a HyperLogLog.
+ * @param hll the HyperLogLog
+ * @return the number of bytes of the registers
+ */
+size_t hyperLogLogBytes(HyperLogLog hll) {
+    return hll.nbRegisters * sizeof(uint8_t);
+}
+
+
+/**
+ * Create an empty count-min sketch.
+ *
+ * @param epsilon the error on the counts, relatively to the total count,
+ * for example 0.001. The width is the power of 2 larger than e/epsilon.
+ * @param delta the probability that the error is larger, for example 0.01.
+ * The depth is ln(1/delta) rounded up.
+ * @return the sketch, that must be destroyed by countMinSketchDestroy
+ */
+CountMinSketch countMinSketchCreate(double epsilon, double delta) {
+    CountMinSketch sketch;
+    sketch.logWidth = 1;
+    while (sketch.logWidth < 40 && (double)((uint64_t)1 << sketch.logWidth) * epsilon < 2.718281828459045) {
+        sketch.logWidth++;
+    }
+    sketch.width = (size_t)1 << sketch.logWidth;
+    sketch.depth = 1;
+    if (delta > 0 && delta < 1) {
+        sketch.depth = (size_t)ceil(log(1 / delta));
+        if (sketch.depth == 0) {
+            sketch.depth = 1;
+        }
+    }
+    sketch.total = 0;
+    sketch.counters = (uint64_t *)calloc(sketch.width * sketch.depth, sizeof(uint64_t));
+    return sketch;
+}
+
+/**
+ * Free the memory used by a count-min sketch.
+ * @param sketch pointer to the sketch to free
+ */
+void countMinSketchDestroy(CountMinSketch *sketch) {
+    free(sketch->counters);
+    sketch->counters = NULL;
+    sketch->width = 0;
+    sketch->depth = 0;
+    sketch->total = 0;
+}
+
+/**
+ * @brief Computes the two hash codes of a key used to choose its counters
+ *
+ * @param key the key
+ * @param sizeKey the length of the key
+ * @param h1 receives the first hash code
+ * @param h2 receives the second hash code, which is odd
+ */
+static void countMinSketchHashes(string key, size_t sizeKey, uint64_t *h1, uint64_t *h2) {
+    uint64_t hash = wyhash64(key, sizeKey);
+    *h1 = hash;
+    *h2 = (((hash >> 32) | (hash << 32)) * 0x9E3779B97F4A7C15ULL) | 1;
+}
+
+/**
+ * Add occurrences of a key to a count-min sketch.
+ * @param sketch pointer to the sketch
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param count the number of occurrences to add
+ */
+void countMinSketchAdd(CountMinSketch *sketch, string key, size_t sizeKey, uint64_t count) {
+    uint64_t h1, h2;
+    countMinSketchHashes(key, sizeKey, &h1, &h2);
+    uint64_t *row = sketch->counters;
+    for (size_t i = 0; i < sketch->depth; i++) {
+        row[(h1 + i * h2) >> (64 - sketch->logWidth)] += count;
+        row += sketch->width;
+    }
+    sketch->total += count;
+}
+
+/**
+ * Estimate the number of occurrences of a key.
+ * @param sketch the sketch
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return an estimate never smaller than the number of occurrences
+ */
+uint64_t countMinSketchEstimate(CountMinSketch sketch, string key, size_t sizeKey) {
+    uint64_t h1, h2;
+    countMinSketchHashes(key, sizeKey, &h1, &h2);
+    uint64_t estimate = UINT64_MAX;
+    uint64_t *row = sketch.counters;
+    for (size_t i = 0; i < sketch.depth; i++) {
+        uint64_t counter = row[(h1 + i * h2) >> (64 - sketch.logWidth)];
+        if (counter < estimate) {
+            estimate = counter;
+        }
+        row += sketch.width;
+    }
+    return estimate;
+}
+
+/**
+ * Returns the number of bytes used by a count-min sketch.
+ * @param sketch the sketch
+ * @return the number of bytes of the counters
+ */
+size_t countMinSketchBytes(CountMinSketch sketch) {
+    return sketch.width * sketch.depth * sizeof(uint64_t);
+}
@@ -0,0 +1,148 @@
+/**
+ * @file sketch.h
+ * @brief Header file for approximate counting with a fixed memory
+ *
+ * This file contains the declaration of two sketches that replace a
+ * counting HashTable when the number of distinct keys is too large for
+ * the memory. Their size only depends on the error bounds chosen when
+ * they are created, never on the number of keys added:
+ * - a HyperLogLog estimates the number of distinct keys,
+ * - a count-min sketch estimates the number of occurrences of each key.
+ * Both hash the keys with the 64-bit function wyhash64.
+ */
+
+
+#ifndef SKETCH_H_INCLUDED
+#define SKETCH_H_INCLUDED
+
+#include <stdint.h>
+#include "hashtable.h"
+
+/**
+ * @brief Smallest and largest numbers of bits of the register index of a HyperLogLog
+ */
+#define HYPERLOGLOG_MIN_PRECISION 4
+#define HYPERLOGLOG_MAX_PRECISION 18
+
+/**
+ * @brief Definition of a HyperLogLog
+ *
+ * The first [precision] bits of the hash code of a key select one of the
+ * [nbRegisters] = 2^precision registers, which keeps the largest rank of
+ * the first 1 bit among the other bits of the hash codes it received.
+ * The standard error of the estimate is 1.04/sqrt(nbRegisters).
+ */
+typedef struct hyperLogLog{
+    int precision; /**< Number of bits of the register index */
+    size_t nbRegisters; /**< Number of registers, 2^precision */
+    uint8_t *registers; /**< Largest rank of each register */
+} HyperLogLog;
+
+/**
+ * @brief Definition of a count-min sketch
+ *
+ * The sketch has [depth] rows of [width] counters. A key increments one
+ * counter per row, chosen by a hash of the key for this row, and its count
+ * is estimated by the smallest of its counters: the estimate is never
+ * smaller than the true count, and it is larger by at most epsilon times
+ * the total count with probability 1-delta.
+ */
+typedef struct countMinSketch{
+    size_t width; /**< Number of counters per row, a power of 2 */
+    int logWidth; /**< log2(width) */
+    size_t depth; /**< Number of rows */
+    uint64_t total; /**< Sum of the counts added */
+    uint64_t *counters; /**< depth rows of width counters */
+} CountMinSketch;
+
+
+/**
+ * Create an empty HyperLogLog.
+ *
+ * @param relativeError the wanted standard error of the estimate, for example
+ * 0.01 for 1% (16 KB). The number of registers is the smallest power of 2
+ * that gives this error, between 2^HYPERLOGLOG_MIN_PRECISION and
+ * 2^HYPERLOGLOG_MAX_PRECISION.
+ * @return the HyperLogLog, that must be destroyed by hyperLogLogDestroy
+ */
+HyperLogLog hyperLogLogCreate(double relativeError);
+
+/**
+ * Free the memory used by a HyperLogLog.
+ * @param hll pointer to the HyperLogLog to free
+ */
+void hyperLogLogDestroy(HyperLogLog *hll);
+
+/**
+ * Add a key to a HyperLogLog.
+ * @param hll pointer to the HyperLogLog
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ */
+void hyperLogLogAdd(HyperLogLog *hll, string key, size_t sizeKey);
+
+/**
+ * Add the keys of a HyperLogLog to another one, for example to gather
+ * the counts of several threads.
+ * @param destination pointer to the HyperLogLog that receives the keys
+ * @param source HyperLogLog with the same precision
+ */
+void hyperLogLogMerge(HyperLogLog *destination, HyperLogLog source);
+
+/**
+ * Estimate the number of distinct keys added to a HyperLogLog.
+ * @param hll the HyperLogLog
+ * @return the estimated number of distinct keys
+ */
+double hyperLogLogCount(HyperLogLog hll);
+
+/**
+ * Returns the number of bytes used by a HyperLogLog.
+ * @param hll the HyperLogLog
+ * @return the number of bytes of the registers
+ */
+size_t hyperLogLogBytes(HyperLogLog hll);
+
+/**
+ * Create an empty count-min sketch.
+ *
+ * @param epsilon the error on the counts, relatively to the total count,
+ * for example 0.001. The width is the power of 2 larger than e/epsilon.
+ * @param delta the probability that the error is larger, for example 0.01.
+ * The depth is ln(1/delta) rounded up.
+ * @return the sketch, that must be destroyed by countMinSketchDestroy
+ */
+CountMinSketch countMinSketchCreate(double epsilon, double delta);
+
+/**
+ * Free the memory used by a count-min sketch.
+ * @param sketch pointer to the sketch to free
+ */
+void countMinSketchDestroy(CountMinSketch *sketch);
+
+/**
+ * Add occurrences of a key to a count-min sketch.
+ * @param sketch pointer to the sketch
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @param count the number of occurrences to add
+ */
+void countMinSketchAdd(CountMinSketch *sketch, string key, size_t sizeKey, uint64_t count);
+
+/**
+ * Estimate the number of occurrences of a key.
+ * @param sketch the sketch
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ * @return an estimate never smaller than the number of occurrences
+ */
+uint64_t countMinSketchEstimate(CountMinSketch sketch, string key, size_t sizeKey);
+
+/**
+ * Returns the number of bytes used by a count-min sketch.
+ * @param sketch the sketch
+ * @return the number of bytes of the counters
+ */
+size_t countMinSketchBytes(CountMinSketch sketch);
+
+#endif // SKETCH_H_INCLUDED
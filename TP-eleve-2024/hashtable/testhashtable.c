@@ -11,8 +11,21 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
 #include "hashtable.h"
+#include "openhashtable.h"
+#include "shardedhashtable.h"
+#include "wordcount.h"
+#include "hashfunctions.h"
+#include "frozenhashtable.h"
+#include "topk.h"
+#include "sketch.h"
+#include "concurrenthashtable.h"
 #include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 void testMurmurhash(){
     printf("---- Test murmurhash ----\n");
@@ -204,6 +217,957 @@ void testCountDistinctWordsInBook(){
 
 }
 
+void testOpenHashtable(){
+    printf("---- Test openHashtable ----\n");
+
+    int nbOperations=100000;
+    int nbKeys=5000;
+    HashTable table = hashtableCreate(1);
+    OpenHashTable openTable = openHashtableCreate(1);
+    char key[20];
+    for(int i=0;i<nbOperations;i++){
+        sprintf(key,"key %d",rand()%nbKeys);
+        if(rand()%3==0){
+            if(hashtableRemove(&table,key)!=openHashtableRemove(&openTable,key)){
+                printf("Different results for the removal of '%s'\n",key);
+            }
+        }
+        else{
+            int value=rand()%100;
+            hashtableInsert(&table,key,value);
+            openHashtableInsert(&openTable,key,value);
+        }
+    }
+    int nbErrors=0;
+    for(int i=0;i<2*nbKeys;i++){
+        sprintf(key,"key %d",i);
+        if(hashtableHasKey(table,key)!=openHashtableHasKey(openTable,key)
+           || hashtableGetValue(table,key)!=openHashtableGetValue(openTable,key)){
+            nbErrors++;
+        }
+    }
+    printf("Number of pairs: %zu (chained) %zu (open)\n",table.numberOfPairs,openTable.numberOfPairs);
+    printf("Number of different answers: %d\n",nbErrors);
+    hashtableDestroy(&table);
+    openHashtableDestroy(&openTable);
+    printf("---- Fin Test openHashtable ----\n");
+}
+
+double maximalInsertTime(HashTable *table, int nbKeys){
+    char key[20];
+    double maxTime=0;
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        clock_t start=clock();
+        hashtableInsert(table,key,i);
+        double time=(double)(clock()-start)/CLOCKS_PER_SEC;
+        if(time>maxTime)
+            maxTime=time;
+    }
+    return maxTime;
+}
+
+void testIncrementalResizing(){
+    printf("---- Test incremental resizing ----\n");
+
+    int nbKeys=1000000;
+    HashTable atOnceTable = hashtableCreate(1);
+    printf("Maximal insertion time (resizing at once): %f s\n",maximalInsertTime(&atOnceTable,nbKeys));
+
+    HashTable table = hashtableCreate(1);
+    hashtableSetIncremental(&table,1);
+    printf("Maximal insertion time (incremental resizing): %f s\n",maximalInsertTime(&table,nbKeys));
+    int nbErrors=0;
+    char key[20];
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        if(hashtableGetValue(table,key)!=i)
+            nbErrors++;
+    }
+    printf("Number of pairs: %zu, number of wrong values: %d\n",table.numberOfPairs,nbErrors);
+    hashtableDestroy(&atOnceTable);
+    hashtableDestroy(&table);
+    printf("---- Fin Test incremental resizing ----\n");
+}
+
+void testHashtableKeyLength(){
+    printf("---- Test keys given with their length ----\n");
+
+    char text[]="the cat and the dog and the bird";
+    HashTable table = hashtableCreate(1);
+    size_t start=0;
+    size_t length=strlen(text);
+    for(size_t i=0;i<=length;i++){
+        if(i==length || text[i]==' '){
+            string word=text+start;
+            size_t sizeWord=i-start;
+            int count=hashtableGetValueLen(table,word,sizeWord);
+            hashtableInsertLen(&table,word,sizeWord,count==-1?1:count+1);
+            start=i+1;
+        }
+    }
+    hashtablePrint(table);
+    printf("'the': %d, 'and': %d, 'bird': %d\n",hashtableGetValue(table,"the"),
+           hashtableGetValue(table,"and"),hashtableGetValue(table,"bird"));
+
+    char binaryKey[3]={'a','\0','b'};
+    hashtableInsertLen(&table,binaryKey,3,42);
+    printf("Key 'a\\0b': %d, key 'a': %d\n",hashtableGetValueLen(table,binaryKey,3),
+           hashtableHasKey(table,"a"));
+    int removed=hashtableRemoveLen(&table,binaryKey,3);
+    printf("Remove 'a\\0b': %d, remove again: %d\n",removed,hashtableRemoveLen(&table,binaryKey,3));
+    hashtableDestroy(&table);
+    printf("---- Fin Test keys given with their length ----\n");
+}
+
+typedef struct {
+    ShardedHashTable *table;
+    int firstKey;
+    int nbKeys;
+} ShardedWork;
+
+void *shardedWorker(void *argument){
+    ShardedWork *work=(ShardedWork *)argument;
+    char key[20];
+    for(int round=0;round<4;round++){
+        for(int i=0;i<work->nbKeys;i++){
+            sprintf(key,"key %d",work->firstKey+i);
+            shardedHashtableIncrement(work->table,key,1);
+        }
+    }
+    return NULL;
+}
+
+double shardedThroughput(size_t nbShards, int nbThreads, int nbKeysPerThread){
+    ShardedHashTable table = shardedHashtableCreate(nbShards,1);
+    pthread_t threads[nbThreads];
+    ShardedWork works[nbThreads];
+    struct timespec start,end;
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    for(int t=0;t<nbThreads;t++){
+        works[t].table=&table;
+        works[t].firstKey=t*nbKeysPerThread;
+        works[t].nbKeys=nbKeysPerThread;
+        pthread_create(&threads[t],NULL,shardedWorker,&works[t]);
+    }
+    for(int t=0;t<nbThreads;t++){
+        pthread_join(threads[t],NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end);
+    double time=(end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)*1e-9;
+    if(shardedHashtableNumberOfPairs(table)!=(size_t)nbThreads*nbKeysPerThread){
+        printf("Wrong number of pairs: %zu\n",shardedHashtableNumberOfPairs(table));
+    }
+    shardedHashtableDestroy(&table);
+    return 4.0*nbThreads*nbKeysPerThread/time;
+}
+
+void testShardedHashtable(){
+    printf("---- Test shardedHashtable ----\n");
+
+    int nbKeysPerThread=200000;
+    for(int nbThreads=1;nbThreads<=8;nbThreads*=2){
+        printf("%d threads: %.0f op/s with 1 shard, %.0f op/s with 64 shards\n",nbThreads,
+               shardedThroughput(1,nbThreads,nbKeysPerThread),
+               shardedThroughput(64,nbThreads,nbKeysPerThread));
+    }
+    printf("---- Fin Test shardedHashtable ----\n");
+}
+
+void testCountDistinctWordsInBookParallel(){
+    printf("---- Test countWordsInBookParallel ----\n");
+    for(int nbThreads=1;nbThreads<=8;nbThreads*=2){
+        struct timespec start,end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        printf("%d threads:\n",nbThreads);
+        countDistinctWordsInBookParallel(nbThreads);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        printf("Time: %f s\n",(end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)*1e-9);
+    }
+    printf("---- Fin Test countWordsInBookParallel ----\n");
+}
+
+void testTokenizer(){
+    printf("---- Test tokenizer ----\n");
+    FILE *file = fopen("tokenizer-test.txt","w");
+    fprintf(file,"  first\tsecond\n");
+    for(int i=0;i<300;i++)
+        fputc('x',file);
+    fprintf(file," last");
+    fclose(file);
+
+    Tokenizer tokenizer;
+    if(!tokenizerOpen(&tokenizer,"tokenizer-test.txt")){
+        printf("Error:file not found\n");
+        return;
+    }
+    string word;
+    size_t sizeWord;
+    while(tokenizerNext(&tokenizer,&word,&sizeWord)){
+        printf("Word of length %zu: '%.*s'\n",sizeWord,sizeWord<20?(int)sizeWord:20,word);
+    }
+    tokenizerClose(&tokenizer);
+    remove("tokenizer-test.txt");
+    printf("---- Fin Test tokenizer ----\n");
+}
+
+
+void testHashtableArena(){
+    printf("---- Test hashtable arena ----\n");
+    int nbKeys=1000000;
+    char key[20];
+    HashTable tables[2];
+    tables[0] = hashtableCreate(1);
+    tables[1] = hashtableCreateWithArena(1);
+    for(int t=0;t<2;t++){
+        clock_t start=clock();
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"key %d",i);
+            hashtableInsert(&tables[t],key,i);
+        }
+        double insertTime=(double)(clock()-start)/CLOCKS_PER_SEC;
+        for(int i=0;i<nbKeys;i+=2){
+            sprintf(key,"key %d",i);
+            hashtableRemove(&tables[t],key);
+        }
+        int nbErrors=0;
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"key %d",i);
+            if(hashtableGetValue(tables[t],key)!=(i%2==0?-1:i))
+                nbErrors++;
+        }
+        printf("%s: %zu pairs, %d wrong values\n",t==0?"malloc":"arena",tables[t].numberOfPairs,nbErrors);
+        if(tables[t].arena!=NULL)
+            printf("Number of chunks: %zu\n",tables[t].arena->nbChunks);
+        start=clock();
+        hashtableDestroy(&tables[t]);
+        double destroyTime=(double)(clock()-start)/CLOCKS_PER_SEC;
+        printf("Insertion time: %f s, destruction time: %f s\n",insertTime,destroyTime);
+    }
+    printf("---- Fin Test hashtable arena ----\n");
+}
+
+
+/**
+ * @brief Returns the cycle counter, or the time in nanoseconds if there is none
+ */
+static unsigned long long readCycles(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (unsigned long long)now.tv_sec*1000000000ull+now.tv_nsec;
+#endif
+}
+
+static uint64_t murmurhash64(string key, size_t sizeKey){
+    return murmurhash32(key,sizeKey);
+}
+
+/**
+ * @brief Prints the speed of a hash function on a set of keys
+ */
+static void hashFunctionSpeed(string name, HashFunction hashFunction, string *keys, size_t *sizeKeys, size_t nbKeys, int nbRounds){
+    size_t nbBytes=0;
+    for(size_t i=0;i<nbKeys;i++)
+        nbBytes+=sizeKeys[i];
+    uint64_t sink=0;
+    unsigned long long start=readCycles();
+    for(int r=0;r<nbRounds;r++)
+        for(size_t i=0;i<nbKeys;i++)
+            sink+=hashFunction(keys[i],sizeKeys[i]);
+    unsigned long long cycles=readCycles()-start;
+    printf("%-20s %6.3f bytes/cycle, %6.1f cycles/key (%llx)\n",name,
+           (double)nbBytes*nbRounds/cycles,(double)cycles/((double)nbKeys*nbRounds),(unsigned long long)(sink&0xfff));
+}
+
+void testHashFunctions(){
+    printf("---- Test hash functions ----\n");
+    HashFunction functions[4]={murmurhash64,wyhash64,stripeHash64,stripeHash64Scalar};
+    string names[4]={"murmurhash32","wyhash64","stripeHash64","stripeHash64Scalar"};
+
+    // the vectorized and scalar versions give the same hash codes
+    char longKey[5000];
+    for(int i=0;i<5000;i++)
+        longKey[i]=(char)(i*7+i/13);
+    int nbDifferences=0;
+    for(size_t size=0;size<=5000;size+=37)
+        if(stripeHash64(longKey,size)!=stripeHash64Scalar(longKey,size))
+            nbDifferences++;
+    printf("Vectorized and scalar stripe hashes differ %d times\n",nbDifferences);
+
+    // changing the hash function of a filled table keeps its pairs
+    HashTable table=hashtableCreate(10);
+    char key[20];
+    for(int i=0;i<1000;i++){
+        sprintf(key,"key %d",i);
+        hashtableInsert(&table,key,i);
+    }
+    hashtableSetHashFunction(&table,wyhash64);
+    int nbErrors=0;
+    for(int i=0;i<1000;i++){
+        sprintf(key,"key %d",i);
+        if(hashtableGetValue(table,key)!=i)
+            nbErrors++;
+    }
+    printf("After the change of hash function: %zu pairs, %d wrong values\n",table.numberOfPairs,nbErrors);
+    hashtableDestroy(&table);
+
+    // distribution of the keys of the word count
+    Tokenizer tokenizer;
+    if(!tokenizerOpen(&tokenizer,"potter-clean.txt")){
+        printf("Error:file not found\n");
+        return;
+    }
+    size_t nbWords=0;
+    string word;
+    size_t sizeWord;
+    Tokenizer counter=tokenizer;
+    while(tokenizerNext(&counter,&word,&sizeWord))
+        nbWords++;
+    string *words=(string *)malloc(nbWords*sizeof(string));
+    size_t *sizeWords=(size_t *)malloc(nbWords*sizeof(size_t));
+    for(size_t i=0;tokenizerNext(&tokenizer,&words[i],&sizeWords[i]);i++);
+    printf("Words of the book (%zu keys):\n",nbWords);
+    for(int f=0;f<4;f++)
+        hashFunctionSpeed(names[f],functions[f],words,sizeWords,nbWords,20);
+
+    string longKeys[1]={longKey};
+    size_t sizeLongKeys[1]={4096};
+    printf("Keys of 4096 bytes:\n");
+    for(int f=0;f<4;f++)
+        hashFunctionSpeed(names[f],functions[f],longKeys,sizeLongKeys,1,20000);
+
+    // the whole word count, with a division or a mask to select the buckets
+    for(int f=0;f<2;f++){
+        table=f==0?hashtableCreate(1000):hashtableCreateWithHash(1000,functions[f]);
+        unsigned long long start=readCycles();
+        for(int r=0;r<20;r++)
+            for(size_t i=0;i<nbWords;i++)
+                hashtableIncrementLen(&table,words[i],sizeWords[i],1);
+        unsigned long long cycles=readCycles()-start;
+        printf("Word count with %s (table of size %zu): %.1f cycles/word, %zu distinct words\n",
+               names[f],table.sizeTable,(double)cycles/(20.0*nbWords),table.numberOfPairs);
+        hashtableDestroy(&table);
+    }
+    free(words);
+    free(sizeWords);
+    tokenizerClose(&tokenizer);
+    printf("---- Fin Test hash functions ----\n");
+}
+
+
+void testFrozenHashtable(){
+    printf("---- Test frozen hashtable ----\n");
+    HashTable table=countWordsInFileParallel("potter-clean.txt",1);
+    FrozenHashTable frozen=frozenHashtableCreate(table);
+    printf("Frozen pairs: %zu, buckets: %zu\n",frozen.numberOfPairs,frozen.nbBuckets);
+    int nbErrors=0;
+    size_t sizeKeys=0;
+    for(size_t i=0;i<table.sizeTable;i++)
+        for(Cell *cell=table.table[i];cell!=NULL;cell=cell->nextCell){
+            sizeKeys+=cell->sizeKey;
+            if(frozenHashtableGetValue(frozen,cell->key)!=cell->value)
+                nbErrors++;
+        }
+    printf("Wrong values: %d\n",nbErrors);
+    printf("'the': %d, 'and': %d, 'unknownword': %d, has 'unknownword': %d\n",
+           frozenHashtableGetValue(frozen,"the"),frozenHashtableGetValue(frozen,"and"),
+           frozenHashtableGetValue(frozen,"unknownword"),frozenHashtableHasKey(frozen,"unknownword"));
+    printf("Bytes: %zu for %zu bytes of keys (hash table: at least %zu)\n",frozenHashtableBytes(frozen),sizeKeys,
+           table.sizeTable*sizeof(List)+table.numberOfPairs*(sizeof(Cell)+1)+sizeKeys);
+    frozenHashtableDestroy(&frozen);
+    hashtableDestroy(&table);
+
+    int nbKeys=1000000;
+    char key[20];
+    table=hashtableCreate(1);
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        hashtableInsert(&table,key,i);
+    }
+    clock_t start=clock();
+    frozen=frozenHashtableCreate(table);
+    printf("Freezing %d pairs: %f s\n",nbKeys,(double)(clock()-start)/CLOCKS_PER_SEC);
+    // lookups in a random order, the keys being written beforehand
+    char (*keys)[20]=malloc(nbKeys*sizeof(*keys));
+    for(int i=0;i<nbKeys;i++)
+        sprintf(keys[i],"key %d",(int)(((long long)i*7919)%nbKeys));
+    long long sum=0;
+    start=clock();
+    for(int i=0;i<nbKeys;i++)
+        sum+=hashtableGetValue(table,keys[i]);
+    printf("Lookups in the hash table: %f s (%lld)\n",(double)(clock()-start)/CLOCKS_PER_SEC,sum);
+    sum=0;
+    start=clock();
+    for(int i=0;i<nbKeys;i++)
+        sum+=frozenHashtableGetValue(frozen,keys[i]);
+    printf("Lookups in the frozen hash table: %f s (%lld)\n",(double)(clock()-start)/CLOCKS_PER_SEC,sum);
+    free(keys);
+    frozenHashtableDestroy(&frozen);
+    hashtableDestroy(&table);
+    printf("---- Fin Test frozen hashtable ----\n");
+}
+
+
+void testFrozenSnapshot(){
+    printf("---- Test frozen snapshot ----\n");
+    clock_t start=clock();
+    HashTable table=countWordsInFileParallel("potter-clean.txt",1);
+    printf("Counting the words of the book: %f s\n",(double)(clock()-start)/CLOCKS_PER_SEC);
+    FrozenHashTable frozen=frozenHashtableCreate(table);
+    printf("Saved: %d\n",frozenHashtableSave(frozen,"snapshot-test.bin"));
+    frozenHashtableDestroy(&frozen);
+
+    start=clock();
+    FrozenHashTable loaded=frozenHashtableLoad("snapshot-test.bin");
+    printf("Loading the snapshot: %f s, %zu pairs\n",(double)(clock()-start)/CLOCKS_PER_SEC,loaded.numberOfPairs);
+    int nbErrors=0;
+    for(size_t i=0;i<table.sizeTable;i++)
+        for(Cell *cell=table.table[i];cell!=NULL;cell=cell->nextCell)
+            if(frozenHashtableGetValueLen(loaded,cell->key,cell->sizeKey)!=cell->value)
+                nbErrors++;
+    printf("Wrong values: %d, 'the': %d, has 'unknownword': %d\n",nbErrors,
+           frozenHashtableGetValue(loaded,"the"),frozenHashtableHasKey(loaded,"unknownword"));
+    frozenHashtableDestroy(&loaded);
+    hashtableDestroy(&table);
+
+    // an empty table and a file that is not a snapshot
+    table=hashtableCreate(4);
+    frozen=frozenHashtableCreate(table);
+    frozenHashtableSave(frozen,"snapshot-test.bin");
+    loaded=frozenHashtableLoad("snapshot-test.bin");
+    printf("Empty snapshot: %zu pairs, 'the': %d\n",loaded.numberOfPairs,frozenHashtableGetValue(loaded,"the"));
+    frozenHashtableDestroy(&loaded);
+    hashtableDestroy(&table);
+    loaded=frozenHashtableLoad("potter-clean.txt");
+    printf("Text file: %zu pairs\n",loaded.numberOfPairs);
+
+    // corrupted snapshots: overflowing size, decreasing offset, offset after the keys
+    table=hashtableCreate(4);
+    hashtableInsert(&table,"alpha",1);
+    hashtableInsert(&table,"beta",2);
+    hashtableInsert(&table,"gamma",3);
+    frozen=frozenHashtableCreate(table);
+    for(int corruption=0;corruption<3;corruption++){
+        frozenHashtableSave(frozen,"snapshot-test.bin");
+        FILE *file=fopen("snapshot-test.bin","r+b");
+        FrozenSnapshotHeader header;
+        if(fread(&header,sizeof(header),1,file)!=1)
+            printf("Error:cannot read the snapshot\n");
+        long slots=(long)(sizeof(header)+header.nbBuckets*sizeof(uint32_t));
+        uint32_t offset;
+        if(corruption==0){
+            // nbBuckets*4 wraps around to the right size
+            header.nbBuckets+=(uint64_t)1<<62;
+            fseek(file,0,SEEK_SET);
+            fwrite(&header,sizeof(header),1,file);
+        }
+        else if(corruption==1){
+            offset=(uint32_t)header.sizeKeys;
+            fseek(file,slots,SEEK_SET);
+            fwrite(&offset,sizeof(offset),1,file);
+        }
+        else{
+            offset=(uint32_t)header.sizeKeys+100;
+            fseek(file,slots+(long)(header.numberOfPairs*sizeof(FrozenSlot)),SEEK_SET);
+            fwrite(&offset,sizeof(offset),1,file);
+        }
+        fclose(file);
+        loaded=frozenHashtableLoad("snapshot-test.bin");
+        printf("Corrupted snapshot %d: %zu pairs, has 'alpha' %d, 'beta' %d, 'gamma' %d\n",corruption,loaded.numberOfPairs,
+               frozenHashtableHasKey(loaded,"alpha"),frozenHashtableHasKey(loaded,"beta"),frozenHashtableHasKey(loaded,"gamma"));
+        frozenHashtableDestroy(&loaded);
+    }
+    frozenHashtableDestroy(&frozen);
+    hashtableDestroy(&table);
+    remove("snapshot-test.bin");
+    printf("---- Fin Test frozen snapshot ----\n");
+}
+
+
+void testHashtableGetValues(){
+    printf("---- Test hashtableGetValues ----\n");
+    int nbKeys=2000000;
+    HashTable table=hashtableCreate(1);
+    char key[20];
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        hashtableInsert(&table,key,i);
+    }
+    // keys in a random order, one out of four not in the table
+    string *keys=(string *)malloc(nbKeys*sizeof(string));
+    for(int i=0;i<nbKeys;i++){
+        keys[i]=(string)malloc(20);
+        int k=(int)(((long long)i*7919)%nbKeys);
+        sprintf(keys[i],k%4==0?"absent %d":"key %d",k);
+    }
+    int *values=(int *)malloc(nbKeys*sizeof(int));
+    clock_t start=clock();
+    for(int i=0;i<nbKeys;i++)
+        values[i]=hashtableGetValue(table,keys[i]);
+    printf("One key at a time: %f s\n",(double)(clock()-start)/CLOCKS_PER_SEC);
+    int *batchValues=(int *)malloc(nbKeys*sizeof(int));
+    start=clock();
+    hashtableGetValues(table,keys,nbKeys,batchValues);
+    printf("Batches of %d keys: %f s\n",HASHTABLE_BATCH_SIZE,(double)(clock()-start)/CLOCKS_PER_SEC);
+    int nbErrors=0;
+    for(int i=0;i<nbKeys;i++){
+        int k=(int)(((long long)i*7919)%nbKeys);
+        if(values[i]!=batchValues[i] || batchValues[i]!=(k%4==0?-1:k))
+            nbErrors++;
+    }
+    printf("Wrong values: %d\n",nbErrors);
+
+    // during an incremental resizing
+    HashTable small=hashtableCreate(1);
+    hashtableSetIncremental(&small,1);
+    for(int i=0;i<1000;i++)
+        hashtableInsert(&small,keys[i],i);
+    hashtableGetValues(small,keys,1000,batchValues);
+    nbErrors=0;
+    for(int i=0;i<1000;i++)
+        if(batchValues[i]!=i)
+            nbErrors++;
+    printf("Wrong values during a resizing: %d\n",nbErrors);
+    hashtableDestroy(&small);
+
+    for(int i=0;i<nbKeys;i++)
+        free(keys[i]);
+    free(keys);
+    free(values);
+    free(batchValues);
+    hashtableDestroy(&table);
+    printf("---- Fin Test hashtableGetValues ----\n");
+}
+
+
+void testHashtableBloomFilter(){
+    printf("---- Test hashtable Bloom filter ----\n");
+    int nbKeys=1000000;
+    char key[20];
+    for(int incremental=0;incremental<2;incremental++){
+        HashTable tables[2];
+        for(int t=0;t<2;t++){
+            tables[t]=hashtableCreate(1);
+            hashtableSetIncremental(&tables[t],incremental);
+        }
+        hashtableSetBloomFilter(&tables[1],1);
+        for(int t=0;t<2;t++)
+            for(int i=0;i<nbKeys;i++){
+                sprintf(key,"key %d",i);
+                hashtableInsert(&tables[t],key,i);
+            }
+        for(int t=0;t<2;t++){
+            int nbErrors=0;
+            for(int i=0;i<nbKeys;i++){
+                sprintf(key,"key %d",i);
+                if(hashtableGetValue(tables[t],key)!=i)
+                    nbErrors++;
+            }
+            // most of the probes miss
+            int nbFound=0;
+            clock_t start=clock();
+            for(int i=0;i<nbKeys;i++){
+                sprintf(key,"absent %d",i);
+                nbFound+=hashtableHasKey(tables[t],key);
+            }
+            printf("%s%s: %d wrong values, %d absent keys found, misses in %f s\n",
+                   t==0?"Without filter":"With filter",incremental?" (incremental resizing)":"",
+                   nbErrors,nbFound,(double)(clock()-start)/CLOCKS_PER_SEC);
+        }
+        printf("Estimated false positive rate: %f\n",hashtableBloomFalsePositiveRate(tables[1]));
+        for(int t=0;t<2;t++)
+            hashtableDestroy(&tables[t]);
+    }
+    printf("---- Fin Test hashtable Bloom filter ----\n");
+}
+
+
+static uint64_t degenerateHash(string key, size_t sizeKey){
+    (void)key;
+    return sizeKey;
+}
+
+void testHashtableStats(){
+    printf("---- Test hashtable statistics ----\n");
+    HashTable table=countWordsInFileParallel("potter-clean.txt",1);
+    hashtableStatsPrint(hashtableStats(table));
+    hashtableDestroy(&table);
+
+    // a hash function that only depends on the length of the keys
+    table=hashtableCreateWithHash(1,degenerateHash);
+    hashtableSetBloomFilter(&table,1);
+    char key[20];
+    for(int i=0;i<2000;i++){
+        sprintf(key,"key %d",i);
+        hashtableInsert(&table,key,i);
+    }
+    for(int i=0;i<1000;i++){
+        sprintf(key,"absent %d",i);
+        hashtableHasKey(table,key);
+    }
+    hashtableStatsPrint(hashtableStats(table));
+    hashtableDestroy(&table);
+    printf("---- Fin Test hashtable statistics ----\n");
+}
+
+
+void testTopK(){
+    printf("---- Test top-K ----\n");
+    int k=10;
+    TopKEntry exact[10];
+    TopKEntry approximate[10];
+    HashTable table=countWordsInFileParallel("potter-clean.txt",1);
+    size_t nbExact=hashtableTopK(table,k,exact);
+    printf("The %zu most frequent words:\n",nbExact);
+    topKPrint(exact,nbExact);
+
+    // the same words, counted in one pass with 100 counters
+    SpaceSaving summary=spaceSavingCreate(100);
+    Tokenizer tokenizer;
+    string word;
+    size_t sizeWord;
+    tokenizerOpen(&tokenizer,"potter-clean.txt");
+    while(tokenizerNext(&tokenizer,&word,&sizeWord))
+        spaceSavingAdd(&summary,word,sizeWord);
+    tokenizerClose(&tokenizer);
+    size_t nbApproximate=spaceSavingTop(summary,k,approximate);
+    printf("Space-Saving with %zu counters on %lli words:\n",summary.k,summary.nbKeys);
+    topKPrint(approximate,nbApproximate);
+    int nbFound=0;
+    for(size_t i=0;i<nbApproximate;i++)
+        for(size_t j=0;j<nbExact;j++)
+            if(approximate[i].sizeKey==exact[j].sizeKey && memcmp(approximate[i].key,exact[j].key,exact[j].sizeKey)==0)
+                nbFound++;
+    printf("%d of the %zu most frequent words found\n",nbFound,nbExact);
+    spaceSavingDestroy(&summary);
+    hashtableDestroy(&table);
+    printf("---- Fin Test top-K ----\n");
+}
+
+
+void testSketches(){
+    printf("---- Test sketches ----\n");
+    HashTable table=countWordsInFileParallel("potter-clean.txt",1);
+    printf("Exact number of distinct words: %lli (%zu bytes)\n",
+           NumberofCellules(table),hashtableStats(table).bytesTotal);
+    double errors[3]={0.1,0.01,0.005};
+    for(int e=0;e<3;e++)
+        countDistinctWordsInBookApproximate(errors[e]);
+
+    // frequencies of the words with a count-min sketch of error 0.1% of the total
+    CountMinSketch sketch=countMinSketchCreate(0.001,0.01);
+    for(size_t i=0;i<table.sizeTable;i++)
+        for(Cell *cell=table.table[i];cell!=NULL;cell=cell->nextCell)
+            countMinSketchAdd(&sketch,cell->key,cell->sizeKey,cell->value);
+    int nbUnderestimated=0;
+    int nbExact=0;
+    uint64_t maxError=0;
+    for(size_t i=0;i<table.sizeTable;i++)
+        for(Cell *cell=table.table[i];cell!=NULL;cell=cell->nextCell){
+            uint64_t estimate=countMinSketchEstimate(sketch,cell->key,cell->sizeKey);
+            if(estimate<(uint64_t)cell->value)
+                nbUnderestimated++;
+            else if(estimate-cell->value>maxError)
+                maxError=estimate-cell->value;
+            nbExact+=estimate==(uint64_t)cell->value;
+        }
+    printf("Count-min sketch %zux%zu (%zu bytes): %d exact counts, %d underestimated, largest error %llu (bound %.0f)\n",
+           sketch.depth,sketch.width,countMinSketchBytes(sketch),nbExact,nbUnderestimated,
+           (unsigned long long)maxError,0.001*sketch.total);
+    printf("harry: %i, estimated %llu\n",hashtableGetValue(table,"harry"),
+           (unsigned long long)countMinSketchEstimate(sketch,"harry",5));
+    countMinSketchDestroy(&sketch);
+
+    // many distinct keys
+    HyperLogLog hll=hyperLogLogCreate(0.01);
+    char key[20];
+    for(int i=0;i<10000000;i++){
+        int length=sprintf(key,"key %d",i);
+        hyperLogLogAdd(&hll,key,length);
+    }
+    printf("10000000 distinct keys, estimated %.0f with %zu bytes\n",hyperLogLogCount(hll),hyperLogLogBytes(hll));
+    hyperLogLogDestroy(&hll);
+    hashtableDestroy(&table);
+    printf("---- Fin Test sketches ----\n");
+}
+
+
+void testHashtableLoadFactors(){
+    printf("---- Test hashtable load factors ----\n");
+    int nbKeys=1000000;
+    char key[20];
+    for(int incremental=0;incremental<2;incremental++){
+        HashTable table=hashtableCreate(1);
+        hashtableSetIncremental(&table,incremental);
+        hashtableSetLoadFactors(&table,0.75,0.125);
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"key %d",i);
+            hashtableInsert(&table,key,i);
+        }
+        printf("%d pairs: size %zu, %zu resizings\n",nbKeys,table.sizeTable,table.nbResizes);
+        // purge all the keys but 1000
+        for(int i=1000;i<nbKeys;i++){
+            sprintf(key,"key %d",i);
+            hashtableRemove(&table,key);
+        }
+        int nbErrors=0;
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"key %d",i);
+            if(hashtableGetValue(table,key)!=(i<1000?i:-1))
+                nbErrors++;
+        }
+        printf("After the purge%s: size %zu, %zu resizings, %d errors\n",
+               incremental?" (incremental resizing)":"",table.sizeTable,table.nbResizes,nbErrors);
+        hashtableDestroy(&table);
+    }
+
+    // bulk load after a reservation
+    HashTable table=hashtableCreate(1);
+    clock_t start=clock();
+    hashtableReserve(&table,nbKeys);
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        hashtableInsert(&table,key,i);
+    }
+    printf("Reserved for %d pairs: size %zu, %zu resizings, %f s\n",nbKeys,table.sizeTable,table.nbResizes,
+           (double)(clock()-start)/CLOCKS_PER_SEC);
+    hashtableDestroy(&table);
+    printf("---- Fin Test hashtable load factors ----\n");
+}
+
+
+void testHashtableInlineKeys(){
+    printf("---- Test hashtable inline keys ----\n");
+    int nbKeys=100000;
+    char key[64];
+    // short keys are stored with their cell, long keys on their own
+    for(int sizeKey=8;sizeKey<=40;sizeKey+=32){
+        HashTable table=hashtableCreateWithInlineKeys(1);
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"%0*d",sizeKey,i);
+            hashtableInsert(&table,key,i);
+        }
+        int nbInline=0;
+        for(size_t i=0;i<table.sizeTable;i++)
+            for(Cell *cell=table.table[i];cell!=NULL;cell=cell->nextCell)
+                nbInline+=cell->key==(string)(cell+1);
+        for(int i=0;i<nbKeys;i+=2){
+            sprintf(key,"%0*d",sizeKey,i);
+            hashtableRemove(&table,key);
+        }
+        int nbErrors=0;
+        for(int i=0;i<nbKeys;i++){
+            sprintf(key,"%0*d",sizeKey,i);
+            if(hashtableGetValue(table,key)!=(i%2==0?-1:i))
+                nbErrors++;
+        }
+        HashTableStats stats=hashtableStats(table);
+        printf("Keys of %d characters: %d inline keys, %d errors, cells %zu bytes, keys %zu bytes\n",
+               sizeKey,nbInline,nbErrors,stats.bytesCells,stats.bytesKeys);
+        hashtableDestroy(&table);
+    }
+    printf("---- Fin Test hashtable inline keys ----\n");
+}
+
+
+static int sumValues(int valueDestination, int valueSource){
+    return valueDestination+valueSource;
+}
+
+void testHashtableMerge(){
+    printf("---- Test hashtable merge ----\n");
+    int nbKeys=100000;
+    char key[64];
+    // the keys 0..nbKeys-1 in the destination, nbKeys/2..3nbKeys/2-1 in the source
+    for(int mode=0;mode<8;mode++){
+        int arenaDestination=mode&1, arenaSource=(mode>>1)&1, sameHash=!((mode>>2)&1);
+        HashTable destination=arenaDestination?hashtableCreateWithArena(1):hashtableCreate(1);
+        HashTable source=arenaSource?hashtableCreateWithArena(1):hashtableCreate(1);
+        hashtableSetBloomFilter(&destination,1);
+        if(!sameHash)
+            hashtableSetHashFunction(&source,wyhash64);
+        for(int i=0;i<nbKeys;i++){
+            // some long keys, which are not stored inline
+            sprintf(key,i%10==0?"a long key number %40d":"key %d",i);
+            hashtableInsert(&destination,key,i);
+            sprintf(key,i%10==0?"a long key number %40d":"key %d",i+nbKeys/2);
+            hashtableInsert(&source,key,1);
+        }
+        size_t nbResizes=destination.nbResizes;
+        clock_t start=clock();
+        hashtableMerge(&destination,&source,sumValues);
+        double time=(double)(clock()-start)/CLOCKS_PER_SEC;
+        int nbErrors=0;
+        for(int i=0;i<nbKeys*3/2;i++){
+            sprintf(key,i%10==0?"a long key number %40d":"key %d",i);
+            int expected=i<nbKeys/2?i:(i<nbKeys?i+1:1);
+            if(hashtableGetValue(destination,key)!=expected)
+                nbErrors++;
+        }
+        printf("Arena %d/%d, %s hash functions: %zu pairs, %zu resizings, %d errors, merged in %f s\n",
+               arenaDestination,arenaSource,sameHash?"same":"different",destination.numberOfPairs,
+               destination.nbResizes-nbResizes,nbErrors,time);
+        hashtableDestroy(&destination);
+    }
+    printf("---- Fin Test hashtable merge ----\n");
+}
+
+
+typedef struct {
+    ConcurrentHashTable *table;
+    HashTable *lockedTable;
+    pthread_rwlock_t *lock;
+    int nbKeys;
+    int nbLookups;
+    int nbErrors;
+    atomic_int *stop;
+} ConcurrentWork;
+
+void *concurrentReaderWorker(void *argument){
+    ConcurrentWork *work=(ConcurrentWork *)argument;
+    char key[20];
+    int reader=work->table!=NULL?concurrentHashtableRegisterReader(work->table):-1;
+    unsigned int seed=(unsigned int)work->nbLookups;
+    for(int i=0;i<work->nbLookups;i++){
+        int k=rand_r(&seed)%work->nbKeys;
+        sprintf(key,"key %d",k);
+        int value;
+        if(work->table!=NULL){
+            value=concurrentHashtableGetValue(work->table,reader,key);
+        }
+        else{
+            pthread_rwlock_rdlock(work->lock);
+            value=hashtableGetValue(*work->lockedTable,key);
+            pthread_rwlock_unlock(work->lock);
+        }
+        if(value!=k)
+            work->nbErrors++;
+    }
+    if(work->table!=NULL)
+        concurrentHashtableUnregisterReader(work->table,reader);
+    return NULL;
+}
+
+void *concurrentWriterWorker(void *argument){
+    ConcurrentWork *work=(ConcurrentWork *)argument;
+    char key[20];
+    // keys that are not read: inserted, then removed, 100 updates per millisecond
+    struct timespec pause={0,1000000};
+    for(int i=0;!atomic_load(work->stop);i++){
+        if(i%100==0)
+            nanosleep(&pause,NULL);
+        sprintf(key,"other key %d",i%100000);
+        if(work->table!=NULL){
+            if(i/100000%2==0)
+                concurrentHashtableInsert(work->table,key,i);
+            else
+                concurrentHashtableRemove(work->table,key);
+        }
+        else{
+            pthread_rwlock_wrlock(work->lock);
+            if(i/100000%2==0)
+                hashtableInsert(work->lockedTable,key,i);
+            else
+                hashtableRemove(work->lockedTable,key);
+            pthread_rwlock_unlock(work->lock);
+        }
+    }
+    return NULL;
+}
+
+double concurrentThroughput(int lockFree, int nbThreads, int nbLookupsPerThread, int *nbErrors){
+    int nbKeys=100000;
+    char key[20];
+    ConcurrentHashTable *table=NULL;
+    HashTable lockedTable=hashtableCreate(1);
+    pthread_rwlock_t lock;
+    pthread_rwlock_init(&lock,NULL);
+    if(lockFree)
+        table=concurrentHashtableCreate(1);
+    for(int i=0;i<nbKeys;i++){
+        sprintf(key,"key %d",i);
+        if(lockFree)
+            concurrentHashtableInsert(table,key,i);
+        else
+            hashtableInsert(&lockedTable,key,i);
+    }
+    atomic_int stop;
+    atomic_init(&stop,0);
+    pthread_t threads[nbThreads+1];
+    ConcurrentWork works[nbThreads+1];
+    struct timespec start,end;
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    for(int t=0;t<=nbThreads;t++){
+        works[t].table=table;
+        works[t].lockedTable=&lockedTable;
+        works[t].lock=&lock;
+        works[t].nbKeys=nbKeys;
+        works[t].nbLookups=nbLookupsPerThread;
+        works[t].nbErrors=0;
+        works[t].stop=&stop;
+        pthread_create(&threads[t],NULL,t==nbThreads?concurrentWriterWorker:concurrentReaderWorker,&works[t]);
+    }
+    for(int t=0;t<nbThreads;t++){
+        pthread_join(threads[t],NULL);
+        *nbErrors+=works[t].nbErrors;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&end);
+    atomic_store(&stop,1);
+    pthread_join(threads[nbThreads],NULL);
+    double time=(end.tv_sec-start.tv_sec)+(end.tv_nsec-start.tv_nsec)*1e-9;
+    if(lockFree)
+        concurrentHashtableDestroy(table);
+    hashtableDestroy(&lockedTable);
+    pthread_rwlock_destroy(&lock);
+    return (double)nbThreads*nbLookupsPerThread/time;
+}
+
+void testConcurrentHashtable(){
+    printf("---- Test concurrentHashtable ----\n");
+    int nbLookupsPerThread=500000;
+    for(int nbThreads=1;nbThreads<=8;nbThreads*=2){
+        int nbErrors=0;
+        double lockFree=concurrentThroughput(1,nbThreads,nbLookupsPerThread,&nbErrors);
+        double locked=concurrentThroughput(0,nbThreads,nbLookupsPerThread,&nbErrors);
+        printf("%d readers and 1 writer: %.0f lookups/s without lock, %.0f lookups/s with a read-write lock, %d errors\n",
+               nbThreads,lockFree,locked,nbErrors);
+    }
+    printf("---- Fin Test concurrentHashtable ----\n");
+}
+
+
+void testHashtableGetOrInsert(){
+    printf("---- Test hashtable get or insert ----\n");
+    char key[20];
+    for(int incremental=0;incremental<2;incremental++){
+        HashTable table=hashtableCreate(1);
+        hashtableSetIncremental(&table,incremental);
+        int *counter=hashtableGetOrInsert(&table,"counter",10);
+        int *again=hashtableGetOrInsert(&table,"counter",0);
+        printf("Same pointer for an existing key: %d, value %d\n",counter==again,*again);
+        *counter+=5;
+        // the resizings relink the cells, the pointer stays valid
+        for(int i=0;i<100000;i++){
+            sprintf(key,"key %d",i);
+            (*hashtableGetOrInsertLen(&table,key,strlen(key),0))+=i;
+        }
+        *counter+=5;
+        int nbErrors=0;
+        for(int i=0;i<100000;i++){
+            sprintf(key,"key %d",i);
+            if(hashtableGetValue(table,key)!=i)
+                nbErrors++;
+        }
+        printf("After %zu resizings%s: counter %d (expected 20), %d errors\n",table.nbResizes,
+               incremental?" (incremental resizing)":"",hashtableGetValue(table,"counter"),nbErrors);
+        hashtableDestroy(&table);
+    }
+    printf("---- Fin Test hashtable get or insert ----\n");
+}
+
 
 int main() {
     //testMurmurhash();
@@ -215,6 +1179,26 @@ int main() {
     //testHashtableHasKey();
     //testHashtableGetValue();
     //testHashtableRemove();
+    //testOpenHashtable();
+    //testIncrementalResizing();
+    //testHashtableKeyLength();
+    //testHashtableGetOrInsert();
+    //testShardedHashtable();
+    //testCountDistinctWordsInBookParallel();
+    //testTokenizer();
+    //testHashtableArena();
+    //testHashFunctions();
+    //testFrozenHashtable();
+    //testFrozenSnapshot();
+    //testHashtableGetValues();
+    //testHashtableBloomFilter();
+    //testHashtableStats();
+    //testTopK();
+    //testSketches();
+    //testHashtableLoadFactors();
+    //testHashtableInlineKeys();
+    //testHashtableMerge();
+    //testConcurrentHashtable();
     testCountDistinctWordsInBook();
 
 
@@ -0,0 +1,247 @@
+/**
+ * @file topk.c
+ * @brief Source file for the queries of the K most frequent keys
+ *
+ * Both queries use the min-heap of heap/heap.c on the slots 0..K-1 of an
+ * array of entries, with the counts as priorities: the top of the heap is
+ * the slot with the smallest count, which is the one to replace.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "topk.h"
+
+/**
+ * @brief Frees a heap created by createHeap
+ *
+ * @param heap the heap to free
+ */
+static void topKFreeHeap(Heap *heap) {
+    if (heap == NULL) {
+        return;
+    }
+    free(heap->position);
+    free(heap->heap);
+    free(heap->priority);
+    free(heap);
+}
+
+/**
+ * @brief Offers a pair to the K best pairs kept in the heap
+ *
+ * @param heap the heap of the slots
+ * @param slots the array of the K slots
+ * @param k the number of slots
+ * @param cell the pair to offer
+ */
+static void topKOffer(Heap *heap, TopKEntry *slots, size_t k, Cell *cell) {
+    int slot;
+    if ((size_t)heap->nbElements < k) {
+        slot = heap->nbElements;
+        slots[slot].key = cell->key;
+        slots[slot].sizeKey = cell->sizeKey;
+        slots[slot].count = cell->value;
+        slots[slot].error = 0;
+        insertHeap(heap, slot, cell->value);
+        return;
+    }
+    slot = heap->heap[0];
+    if (cell->value <= slots[slot].count) {
+        return;
+    }
+    slots[slot].key = cell->key;
+    slots[slot].sizeKey = cell->sizeKey;
+    slots[slot].count = cell->value;
+    modifyPriorityHeap(heap, slot, cell->value);
+}
+
+
+/**
+ * Find the K keys with the largest values of a hash table.
+ *
+ * The pairs are read once and never copied: the time is in O(n log K)
+ * for n pairs, the memory in O(K). The hash table is not modified.
+ *
+ * @param hashtable the hash table, usually a table of counts
+ * @param k the number of keys to find
+ * @param entries array of at least k entries, that receives the keys by
+ * decreasing values. The keys point into the cells of the hash table and
+ * are valid as long as the hash table is not modified.
+ * @return the number of entries written, min(k, number of pairs)
+ */
+size_t hashtableTopK(HashTable hashtable, size_t k, TopKEntry *entries) {
+    if (k > hashtable.numberOfPairs) {
+        k = hashtable.numberOfPairs;
+    }
+    if (k == 0) {
+        return 0;
+    }
+    Heap *heap = createHeap((int)k);
+    TopKEntry *slots = (TopKEntry *)malloc(k * sizeof(TopKEntry));
+    for (size_t i = 0; i < hashtable.sizeTable; i++) {
+        for (Cell *cell = hashtable.table[i]; cell != NULL; cell = cell->nextCell) {
+            topKOffer(heap, slots, k, cell);
+        }
+    }
+    // the buckets of the old table that are not moved yet during a resizing
+    if (hashtable.resize != NULL && hashtable.resize->oldTable != NULL) {
+        for (size_t i = hashtable.resize->nextBucket; i < hashtable.resize->sizeOldTable; i++) {
+            for (Cell *cell = hashtable.resize->oldTable[i]; cell != NULL; cell = cell->nextCell) {
+                topKOffer(heap, slots, k, cell);
+            }
+        }
+    }
+    // the heap gives the slots by increasing counts
+    size_t nbEntries = heap->nbElements;
+    for (size_t i = nbEntries; i > 0; i--) {
+        entries[i - 1] = slots[removeElement(heap)];
+    }
+    free(slots);
+    topKFreeHeap(heap);
+    return nbEntries;
+}
+
+
+/**
+ * Create a Space-Saving summary with k counters.
+ * @param k the number of counters, at least 1
+ * @return the empty summary
+ *
+ * The summary must be destroyed by spaceSavingDestroy.
+ */
+SpaceSaving spaceSavingCreate(size_t k) {
+    SpaceSaving summary;
+    if (k == 0) {
+        k = 1;
+    }
+    summary.k = k;
+    summary.nbEntries = 0;
+    summary.nbKeys = 0;
+    summary.entries = (TopKEntry *)calloc(k, sizeof(TopKEntry));
+    // the index never holds more than k keys, so it is never resized
+    summary.index = hashtableCreate(2 * k);
+    summary.heap = createHeap((int)k);
+    return summary;
+}
+
+/**
+ * Free the memory used by the summary.
+ * @param summary pointer to the summary to free
+ */
+void spaceSavingDestroy(SpaceSaving *summary) {
+    for (size_t i = 0; i < summary->nbEntries; i++) {
+        free(summary->entries[i].key);
+    }
+    free(summary->entries);
+    summary->entries = NULL;
+    hashtableDestroy(&summary->index);
+    topKFreeHeap(summary->heap);
+    summary->heap = NULL;
+    summary->k = 0;
+    summary->nbEntries = 0;
+    summary->nbKeys = 0;
+}
+
+/**
+ * Add an occurrence of a key to the summary.
+ *
+ * If the key is monitored its count is incremented. Otherwise the key takes
+ * a free counter, or replaces the key with the smallest count c, and gets
+ * the count c+1 with the error c.
+ *
+ * @param summary pointer to the summary
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ */
+void spaceSavingAdd(SpaceSaving *summary, string key, size_t sizeKey) {
+    summary->nbKeys++;
+    int slot = hashtableGetValueLen(summary->index, key, sizeKey);
+    if (slot >= 0) {
+        TopKEntry *entry = &summary->entries[slot];
+        entry->count++;
+        modifyPriorityHeap(summary->heap, slot, entry->count);
+        return;
+    }
+    TopKEntry *entry;
+    if (summary->nbEntries < summary->k) {
+        slot = summary->nbEntries++;
+        entry = &summary->entries[slot];
+        entry->count = 1;
+        entry->error = 0;
+        insertHeap(summary->heap, slot, entry->count);
+    }
+    else {
+        // the key replaces the monitored key with the smallest count
+        slot = summary->heap->heap[0];
+        entry = &summary->entries[slot];
+        hashtableRemoveLen(&summary->index, entry->key, entry->sizeKey);
+        free(entry->key);
+        entry->error = entry->count;
+        entry->count++;
+        modifyPriorityHeap(summary->heap, slot, entry->count);
+    }
+    entry->key = (string)malloc(sizeKey + 1);
+    memcpy(entry->key, key, sizeKey);
+    entry->key[sizeKey] = '\0';
+    entry->sizeKey = sizeKey;
+    hashtableInsertLen(&summary->index, entry->key, sizeKey, slot);
+}
+
+/**
+ * @brief Compares two entries by decreasing counts, for qsort
+ *
+ * @param a pointer to the first entry
+ * @param b pointer to the second entry
+ * @return a negative number if the first entry has the largest count
+ */
+static int topKCompareCounts(const void *a, const void *b) {
+    long long int countA = ((const TopKEntry *)a)->count;
+    long long int countB = ((const TopKEntry *)b)->count;
+    return (countA < countB) - (countA > countB);
+}
+
+/**
+ * Get the keys with the largest counts of the summary.
+ *
+ * A key whose count minus error is larger than the count of the (k+1)-th
+ * entry is certainly among the k most frequent keys of the stream.
+ *
+ * @param summary the summary
+ * @param k the number of keys to get
+ * @param entries array of at least k entries, that receives the keys by
+ * decreasing counts. The keys point into the summary and are valid until
+ * the next call to spaceSavingAdd.
+ * @return the number of entries written, min(k, number of counters in use)
+ */
+size_t spaceSavingTop(SpaceSaving summary, size_t k, TopKEntry *entries) {
+    if (k > summary.nbEntries) {
+        k = summary.nbEntries;
+    }
+    if (k == 0) {
+        return 0;
+    }
+    TopKEntry *sorted = (TopKEntry *)malloc(summary.nbEntries * sizeof(TopKEntry));
+    memcpy(sorted, summary.entries, summary.nbEntries * sizeof(TopKEntry));
+    qsort(sorted, summary.nbEntries, sizeof(TopKEntry), topKCompareCounts);
+    memcpy(entries, sorted, k * sizeof(TopKEntry));
+    free(sorted);
+    return k;
+}
+
+/**
+ * Print the entries of a top-K query, one key per line.
+ * @param entries the entries
+ * @param nbEntries the number of entries
+ */
+void topKPrint(TopKEntry *entries, size_t nbEntries) {
+    for (size_t i = 0; i < nbEntries; i++) {
+        printf("%zu. %.*s: %lli", i + 1, (int)entries[i].sizeKey, entries[i].key, entries[i].count);
+        if (entries[i].error > 0) {
+            printf(" (error at most %lli)", entries[i].error);
+        }
+        printf("\n");
+    }
+}
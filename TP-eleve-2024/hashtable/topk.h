@@ -0,0 +1,120 @@
+/**
+ * @file topk.h
+ * @brief Header file for the queries of the K most frequent keys
+ *
+ * This file contains the declaration of two ways to find the K keys with
+ * the largest counts. The exact query reads the pairs of a counting
+ * HashTable once and keeps the K best pairs in a min-heap of size K
+ * (heap/heap.c): a pair enters the heap only when its count is larger
+ * than the smallest count of the heap, which it replaces.
+ * The streaming mode (Space-Saving) counts an unbounded stream of keys
+ * with K counters only: a new key takes the counter with the smallest
+ * count, and inherits this count as an overestimation. Every key that
+ * appears more than N/K times in a stream of N keys is kept.
+ */
+
+
+#ifndef TOPK_H_INCLUDED
+#define TOPK_H_INCLUDED
+
+#include "hashtable.h"
+#include "../heap/heap.h"
+
+/**
+ * @brief Definition of a key of a top-K query
+ *
+ * The count of the key is exact for hashtableTopK. For the Space-Saving
+ * summary, the true count of the key is between count-error and count.
+ */
+typedef struct topKEntry{
+    string key; /**< Key, not necessarily NUL-terminated */
+    size_t sizeKey; /**< Length of the key */
+    long long int count; /**< Count of the key */
+    long long int error; /**< Maximal overestimation of the count */
+} TopKEntry;
+
+/**
+ * @brief Definition of a Space-Saving summary with K counters
+ *
+ * The counter of a key is found with the hash table [index], which
+ * associates each monitored key with its slot in [entries]. The slots are
+ * the elements of the min-heap [heap], whose priorities are the counts,
+ * so that the counter to replace is at the top of the heap.
+ * The memory is fixed by [k]: it does not depend on the length of the stream.
+ */
+typedef struct spaceSaving{
+    size_t k; /**< Number of counters */
+    size_t nbEntries; /**< Number of counters in use */
+    long long int nbKeys; /**< Number of keys added to the summary */
+    TopKEntry *entries; /**< Counters, the keys are copies owned by the summary */
+    HashTable index; /**< Slot of each monitored key */
+    Heap *heap; /**< Slots ordered by count */
+} SpaceSaving;
+
+
+/**
+ * Find the K keys with the largest values of a hash table.
+ *
+ * The pairs are read once and never copied: the time is in O(n log K)
+ * for n pairs, the memory in O(K). The hash table is not modified.
+ *
+ * @param hashtable the hash table, usually a table of counts
+ * @param k the number of keys to find
+ * @param entries array of at least k entries, that receives the keys by
+ * decreasing values. The keys point into the cells of the hash table and
+ * are valid as long as the hash table is not modified.
+ * @return the number of entries written, min(k, number of pairs)
+ */
+size_t hashtableTopK(HashTable hashtable, size_t k, TopKEntry *entries);
+
+/**
+ * Create a Space-Saving summary with k counters.
+ * @param k the number of counters, at least 1
+ * @return the empty summary
+ *
+ * The summary must be destroyed by spaceSavingDestroy.
+ */
+SpaceSaving spaceSavingCreate(size_t k);
+
+/**
+ * Free the memory used by the summary.
+ * @param summary pointer to the summary to free
+ */
+void spaceSavingDestroy(SpaceSaving *summary);
+
+/**
+ * Add an occurrence of a key to the summary.
+ *
+ * If the key is monitored its count is incremented. Otherwise the key takes
+ * a free counter, or replaces the key with the smallest count c, and gets
+ * the count c+1 with the error c.
+ *
+ * @param summary pointer to the summary
+ * @param key the key, not necessarily NUL-terminated
+ * @param sizeKey the length of the key
+ */
+void spaceSavingAdd(SpaceSaving *summary, string key, size_t sizeKey);
+
+/**
+ * Get the keys with the largest counts of the summary.
+ *
+ * A key whose count minus error is larger than the count of the (k+1)-th
+ * entry is certainly among the k most frequent keys of the stream.
+ *
+ * @param summary the summary
+ * @param k the number of keys to get
+ * @param entries array of at least k entries, that receives the keys by
+ * decreasing counts. The keys point into the summary and are valid until
+ * the next call to spaceSavingAdd.
+ * @return the number of entries written, min(k, number of counters in use)
+ */
+size_t spaceSavingTop(SpaceSaving summary, size_t k, TopKEntry *entries);
+
+/**
+ * Print the entries of a top-K query, one key per line.
+ * @param entries the entries
+ * @param nbEntries the number of entries
+ */
+void topKPrint(TopKEntry *entries, size_t nbEntries);
+
+#endif // TOPK_H_INCLUDED
@@ -0,0 +1,282 @@
+/**
+ * @file wordcount.c
+ * @brief Source file for counting the words of a text file
+ *
+ * The words are never copied out of the mapped file: the tokenizer gives
+ * (pointer, length) slices of the file to hashtableIncrementLen, and a key
+ * is copied only when a new distinct word is added to a hash table.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "wordcount.h"
+#include "hashtable.h"
+#include "hashfunctions.h"
+#include "sketch.h"
+
+/**
+ * @brief Chunk of the file counted by a thread
+ */
+typedef struct wordCountChunk{
+    Tokenizer tokenizer; /**< Words of the chunk */
+    HashTable counts; /**< Occurrences of the words of the chunk */
+} WordCountChunk;
+
+
+/**
+ * Create a tokenizer on the words of a text file.
+ *
+ * @param tokenizer pointer on the tokenizer to initialize
+ * @param fileName name of the text file
+ * @return 1 if the file is mapped, 0 if the file cannot be read
+ */
+int tokenizerOpen(Tokenizer *tokenizer, string fileName) {
+    tokenizer->text = NULL;
+    tokenizer->sizeText = 0;
+    tokenizer->current = NULL;
+    tokenizer->end = NULL;
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) {
+        return 0;
+    }
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) < 0) {
+        close(file);
+        return 0;
+    }
+    if (fileStatus.st_size == 0) {
+        // an empty file cannot be mapped, the tokenizer reads no word
+        close(file);
+        return 1;
+    }
+    size_t size = (size_t)fileStatus.st_size;
+    void *text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (text == MAP_FAILED) {
+        return 0;
+    }
+    madvise(text, size, MADV_SEQUENTIAL);
+    tokenizer->text = (const char *)text;
+    tokenizer->sizeText = size;
+    tokenizer->current = tokenizer->text;
+    tokenizer->end = tokenizer->text + size;
+    return 1;
+}
+
+
+/**
+ * Free the mapping of a tokenizer created by tokenizerOpen.
+ *
+ * @param tokenizer pointer on the tokenizer
+ */
+void tokenizerClose(Tokenizer *tokenizer) {
+    if (tokenizer->text != NULL) {
+        munmap((void *)tokenizer->text, tokenizer->sizeText);
+    }
+    tokenizer->text = NULL;
+    tokenizer->sizeText = 0;
+    tokenizer->current = NULL;
+    tokenizer->end = NULL;
+}
+
+
+/**
+ * Cut the remaining text of a tokenizer into nbParts tokenizers.
+ *
+ * @param tokenizer the tokenizer to cut
+ * @param nbParts the number of parts, at least 1
+ * @param parts array of nbParts tokenizers that receives the parts
+ */
+void tokenizerSplit(Tokenizer tokenizer, int nbParts, Tokenizer *parts) {
+    size_t size = tokenizer.end - tokenizer.current;
+    const char *start = tokenizer.current;
+    for (int p = 0; p < nbParts; p++) {
+        const char *partEnd = tokenizer.current + size / nbParts * (p + 1);
+        if (p == nbParts - 1) {
+            partEnd = tokenizer.end;
+        }
+        if (partEnd < start) {
+            partEnd = start;
+        }
+        while (partEnd < tokenizer.end && !isspace((unsigned char)*partEnd)) {
+            partEnd++;
+        }
+        parts[p].text = NULL;
+        parts[p].sizeText = 0;
+        parts[p].current = start;
+        parts[p].end = partEnd;
+        start = partEnd;
+    }
+}
+
+
+/**
+ * Read the next word of the text.
+ *
+ * @param tokenizer pointer on the tokenizer
+ * @param word receives a pointer on the first character of the word
+ * @param sizeWord receives the length of the word
+ * @return 1 if a word is read, 0 at the end of the text
+ */
+int tokenizerNext(Tokenizer *tokenizer, string *word, size_t *sizeWord) {
+    const char *current = tokenizer->current;
+    const char *end = tokenizer->end;
+    while (current < end && isspace((unsigned char)*current)) {
+        current++;
+    }
+    if (current == end) {
+        tokenizer->current = current;
+        return 0;
+    }
+    const char *start = current;
+    while (current < end && !isspace((unsigned char)*current)) {
+        current++;
+    }
+    tokenizer->current = current;
+    *word = (string)start;
+    *sizeWord = current - start;
+    return 1;
+}
+
+
+/**
+ * @brief Counts the words of a chunk in the hash table of the chunk
+ *
+ * @param argument pointer on the WordCountChunk to count
+ * @return NULL
+ */
+static void *countWordsInChunk(void *argument) {
+    WordCountChunk *chunk = (WordCountChunk *)argument;
+    string word;
+    size_t sizeWord;
+    while (tokenizerNext(&chunk->tokenizer, &word, &sizeWord)) {
+        hashtableIncrementLen(&chunk->counts, word, sizeWord, 1);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Adds the occurrences of a word counted by two threads
+ *
+ * @param countDestination occurrences in the hash table that receives the counts
+ * @param countSource occurrences in the hash table whose counts are added
+ * @return the total number of occurrences
+ */
+static int addCounts(int countDestination, int countSource) {
+    return countDestination + countSource;
+}
+
+
+/**
+ * Count the occurrences of the words of a text file with several threads.
+ *
+ * @param fileName name of the text file
+ * @param nbThreads number of threads (and of chunks)
+ * @return a hash table that associates each word to its number of occurrences,
+ * an empty hash table of size 0 if the file cannot be read
+ */
+HashTable countWordsInFileParallel(string fileName, int nbThreads) {
+    Tokenizer tokenizer;
+    if (!tokenizerOpen(&tokenizer, fileName)) {
+        printf("Error:file not found\n");
+        return hashtableCreate(0);
+    }
+    if (nbThreads < 1) {
+        nbThreads = 1;
+    }
+    WordCountChunk *chunks = (WordCountChunk *)malloc(nbThreads * sizeof(WordCountChunk));
+    Tokenizer *parts = (Tokenizer *)malloc(nbThreads * sizeof(Tokenizer));
+    tokenizerSplit(tokenizer, nbThreads, parts);
+    for (int t = 0; t < nbThreads; t++) {
+        chunks[t].tokenizer = parts[t];
+        chunks[t].counts = hashtableCreateWithArena(1024);
+        hashtableSetHashFunction(&chunks[t].counts, wyhash64);
+    }
+    if (nbThreads == 1) {
+        countWordsInChunk(&chunks[0]);
+    }
+    else {
+        pthread_t *threads = (pthread_t *)malloc(nbThreads * sizeof(pthread_t));
+        for (int t = 0; t < nbThreads; t++) {
+            pthread_create(&threads[t], NULL, countWordsInChunk, &chunks[t]);
+        }
+        for (int t = 0; t < nbThreads; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        free(threads);
+    }
+
+    HashTable counts = chunks[0].counts;
+    for (int t = 1; t < nbThreads; t++) {
+        // the cells and the chunks of the arena are moved, not copied
+        hashtableMerge(&counts, &chunks[t].counts, addCounts);
+    }
+    free(parts);
+    free(chunks);
+    tokenizerClose(&tokenizer);
+    return counts;
+}
+
+
+/**
+ * Prints the number of words and distinct words in the file
+ * "potter-clean.txt"
+ *
+ */
+void countDistinctWordsInBook(){
+    countDistinctWordsInBookParallel(1);
+}
+
+
+/**
+ * Prints the number of words and distinct words in the file
+ * "potter-clean.txt", counted with several threads.
+ *
+ * @param nbThreads number of threads
+ */
+void countDistinctWordsInBookParallel(int nbThreads) {
+    HashTable table = countWordsInFileParallel("potter-clean.txt", nbThreads);
+    if (table.table == NULL) {
+        return;
+    }
+    printf("Number of words: %lli\n", SumofValues(table));
+    printf("Number of distinct words: %lli\n", NumberofCellules(table));
+    hashtableDestroy(&table);
+}
+
+
+/**
+ * Prints the number of words and an estimate of the number of distinct
+ * words in the file "potter-clean.txt", counted with a HyperLogLog whose
+ * memory does not depend on the number of distinct words.
+ *
+ * @param relativeError the standard error of the estimate, for example 0.01
+ */
+void countDistinctWordsInBookApproximate(double relativeError) {
+    Tokenizer tokenizer;
+    if (!tokenizerOpen(&tokenizer, "potter-clean.txt")) {
+        printf("Error:file not found\n");
+        return;
+    }
+    HyperLogLog hll = hyperLogLogCreate(relativeError);
+    long long int nbWords = 0;
+    string word;
+    size_t sizeWord;
+    while (tokenizerNext(&tokenizer, &word, &sizeWord)) {
+        hyperLogLogAdd(&hll, word, sizeWord);
+        nbWords++;
+    }
+    tokenizerClose(&tokenizer);
+    printf("Number of words: %lli\n", nbWords);
+    printf("Approximate number of distinct words: %.0f (%zu bytes)\n", hyperLogLogCount(hll), hyperLogLogBytes(hll));
+    hyperLogLogDestroy(&hll);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file wordcount.h
+ * @brief Header file for counting the words of a text file
+ *
+ * This file contains the declaration of a tokenizer that reads the words
+ * of a text file mapped in memory, and of the functions that count the
+ * words of a file, possibly with several threads. With several threads,
+ * the file is cut into chunks at whitespace boundaries, each thread counts
+ * the words of its chunk in its own hash table, and the hash tables are
+ * merged at the end.
+ */
+
+
+#ifndef WORDCOUNT_H_INCLUDED
+#define WORDCOUNT_H_INCLUDED
+
+#include "hashtable.h"
+
+/**
+ * @brief Definition of a tokenizer
+ *
+ * A tokenizer reads the words of a text mapped in memory. A word is a
+ * maximal sequence of non-whitespace characters, as read by fscanf with
+ * the format "%s". The words are given as (pointer, length) slices of the
+ * text, they are never copied nor NUL-terminated.
+ *
+ * The structure contains the mapped text [text] of size [sizeText]
+ * (NULL if the tokenizer does not own a mapping), the current position
+ * [current] and the end [end] of the part of the text to read.
+ */
+typedef struct tokenizer{
+    const char *text;
+    size_t sizeText;
+    const char *current;
+    const char *end;
+} Tokenizer;
+
+/**
+ * Create a tokenizer on the words of a text file. The file is mapped
+ * in memory, it is not read nor copied.
+ *
+ * @param tokenizer pointer on the tokenizer to initialize
+ * @param fileName name of the text file
+ * @return 1 if the file is mapped, 0 if the file cannot be read
+ */
+int tokenizerOpen(Tokenizer *tokenizer, string fileName);
+
+/**
+ * Free the mapping of a tokenizer created by tokenizerOpen.
+ * The slices given by the tokenizer and its parts become invalid.
+ *
+ * @param tokenizer pointer on the tokenizer
+ */
+void tokenizerClose(Tokenizer *tokenizer);
+
+/**
+ * Cut the remaining text of a tokenizer into nbParts tokenizers of about
+ * the same size. The cuts are moved forward to the next whitespace, so
+ * that each word is read by exactly one part. The parts do not own the
+ * mapping and must not be closed.
+ *
+ * @param tokenizer the tokenizer to cut
+ * @param nbParts the number of parts, at least 1
+ * @param parts array of nbParts tokenizers that receives the parts
+ */
+void tokenizerSplit(Tokenizer tokenizer, int nbParts, Tokenizer *parts);
+
+/**
+ * Read the next word of the text.
+ *
+ * @param tokenizer pointer on the tokenizer
+ * @param word receives a pointer on the first character of the word
+ * @param sizeWord receives the length of the word
+ * @return 1 if a word is read, 0 at the end of the text
+ */
+int tokenizerNext(Tokenizer *tokenizer, string *word, size_t *sizeWord);
+
+/**
+ * Count the occurrences of the words of a text file with several threads.
+ * The keys of the hash table are copied from the mapped file only when a
+ * new distinct word is found.
+ *
+ * @param fileName name of the text file
+ * @param nbThreads number of threads (and of chunks); with 1 thread, the
+ * words are counted by the calling thread
+ * @return a hash table that associates each word to its number of occurrences,
+ * an empty hash table of size 0 if the file cannot be read
+ *
+ * The hash table must be destroyed by the caller.
+ */
+HashTable countWordsInFileParallel(string fileName, int nbThreads);
+
+/**
+ * Prints the number of words and distinct words in the file
+ * "potter-clean.txt"
+ *
+ */
+void countDistinctWordsInBook();
+
+/**
+ * Prints the number of words and distinct words in the file
+ * "potter-clean.txt", counted with several threads.
+ *
+ * @param nbThreads number of threads
+ */
+void countDistinctWordsInBookParallel(int nbThreads);
+
+/**
+ * Prints the number of words and an estimate of the number of distinct
+ * words in the file "potter-clean.txt", counted with a HyperLogLog whose
+ * memory does not depend on the number of distinct words.
+ *
+ * @param relativeError the standard error of the estimate, for example 0.01
+ */
+void countDistinctWordsInBookApproximate(double relativeError);
+
+#endif // WORDCOUNT_H_INCLUDED
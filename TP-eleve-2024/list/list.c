@@ -100,6 +100,28 @@ Cell* findKeyInList(List L, string key) {
     return NULL;
 }
 
+/**
+ * @brief Finds a key with a known length and hash code in a linked list
+ *
+ * @param L Pointer to the linked list to search in
+ * @param key Key to search for, not NULL and not necessarily NUL-terminated
+ * @param sizeKey Length of the key
+ * @param hash Hash code of the key
+ *
+ * @return A pointer to the first cell containing the key, or NULL if the key is not found
+ * The keys are compared only for the cells with the same hash code and length.
+ */
+Cell* findKeyHashInList(List L, string key, size_t sizeKey, uint32_t hash) {
+    while (L != NULL) {
+        if (L->hash == hash && L->sizeKey == sizeKey && L->key != NULL
+            && memcmp(L->key, key, sizeKey) == 0) {
+            return L;
+        }
+        L = L->nextCell;
+    }
+    return NULL;
+}
+
 /**
  * @brief Deletes a key from a linked list
  *
@@ -143,16 +165,74 @@ List delKeyInList(List L, string key) {
  */
 
  List addKeyValueInList(List L, string key, int value) {
-	List newlist;
-	newlist=(List)malloc(sizeof(Cell));
-    if(key==NULL)
-	    newlist->key=NULL;
-    else{
-        newlist->key=strdup(key);
+    List newlist;
+    if(key!=NULL){
+        return addKeyValueHashInList(L, key, strlen(key), value, 0);
     }
+    newlist=(List)malloc(sizeof(Cell));
+    newlist->key=NULL;
+    newlist->sizeKey=0;
+    newlist->value=value;
+    newlist->hash=0;
+    newlist->nextCell=L;
+    return newlist;
+}
 
-	newlist->value=value;
-	newlist->nextCell=L;
-
+/**
+ * @brief Adds a key-value pair with a known length and hash code to a linked list
+ *
+ * @param L Pointer to the linked list to add to
+ * @param key Key to add, not NULL and not necessarily NUL-terminated
+ * @param sizeKey Length of the key, the first sizeKey characters are copied
+ * @param value Value to add
+ * @param hash Hash code of the key, stored in the new cell
+ *
+ * @return A pointer to the modified linked list
+ * The key is copied with its length, followed by a NUL character.
+ */
+List addKeyValueHashInList(List L, string key, size_t sizeKey, int value, uint32_t hash) {
+    List newlist = (List)malloc(sizeof(Cell));
+    newlist->key = (string)malloc((sizeKey + 1) * sizeof(char));
+    memcpy(newlist->key, key, sizeKey);
+    newlist->key[sizeKey] = '\0';
+    newlist->sizeKey = sizeKey;
+    newlist->value = value;
+    newlist->hash = hash;
+    newlist->nextCell = L;
     return newlist;
+}
+
+/**
+ * @brief Deletes a given cell from a linked list
+ *
+ * @param L Pointer to the linked list
+ * @param cell Cell to delete, supposed to be in the list
+ *
+ * @return A pointer to the modified linked list
+ * The cells are compared by address, so that no key comparison is needed.
+ */
+List delCellInList(List L, Cell *cell) {
+    L = unlinkCellInList(L, cell);
+    free(cell->key);
+    free(cell);
+    return L;
+}
+
+/**
+ * @brief Unlinks a given cell from a linked list, without freeing it
+ *
+ * @param L Pointer to the linked list
+ * @param cell Cell to unlink, supposed to be in the list
+ *
+ * @return A pointer to the modified linked list
+ */
+List unlinkCellInList(List L, Cell *cell) {
+    List *previous = &L;
+    while (*previous != NULL && *previous != cell) {
+        previous = &(*previous)->nextCell;
+    }
+    if (*previous != NULL) {
+        *previous = cell->nextCell;
+    }
+    return L;
 }
\ No newline at end of file
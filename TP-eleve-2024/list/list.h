@@ -12,6 +12,9 @@
 #ifndef LIST_H_INCLUDED
 #define LIST_H_INCLUDED
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * @brief Definition of the type string
  *
@@ -21,13 +24,18 @@ typedef char *string;
 /**
  * @brief Definition of a linked list cell and a linked list
  *
- * The structure contains the key (a string), the value (an integer),
- * and a pointer to the next cell in the list.
+ * The structure contains the key (a string), the length of the key,
+ * the value (an integer), the full hash code of the key (used by the
+ * hash tables, 0 otherwise) and a pointer to the next cell in the list.
+ * The key is always followed by a NUL character, but it may contain
+ * NUL characters when it is added with its length.
  * A linked list is just a pointer on the first cell (if it exists).
  */
 typedef struct cell{
     string key; /**< Key of the cell */
+    size_t sizeKey; /**< Length of the key */
     int value; /**< Value of the cell */
+    uint32_t hash; /**< Hash code of the key */
     struct cell *nextCell; /**< Pointer to the next cell in the list */
 } Cell, *List;
 
@@ -71,6 +79,20 @@ void printList(List L,int type);
  */
 Cell* findKeyInList(List L, string key);
 
+/**
+ * @brief Finds a key with a known length and hash code in a linked list
+ *
+ * The keys are compared only for the cells with the same hash code and length.
+ *
+ * @param L Pointer to the linked list to search in
+ * @param key Key to search for, not NULL and not necessarily NUL-terminated
+ * @param sizeKey Length of the key
+ * @param hash Hash code of the key
+ *
+ * @return A pointer to the first cell containing the key, or NULL if the key is not found
+ */
+Cell* findKeyHashInList(List L, string key, size_t sizeKey, uint32_t hash);
+
 /**
  * @brief Deletes a key from a linked list
  *
@@ -94,6 +116,41 @@ List delKeyInList(List L, string key);
  */
 List addKeyValueInList(List L, string key, int value);
 
+/**
+ * @brief Adds a key-value pair with a known length and hash code to a linked list
+ *
+ * @param L Pointer to the linked list to add to
+ * @param key Key to add, not NULL and not necessarily NUL-terminated
+ * @param sizeKey Length of the key, the first sizeKey characters are copied
+ * @param value Value to add
+ * @param hash Hash code of the key, stored in the new cell
+ *
+ * @return A pointer to the modified linked list
+ */
+List addKeyValueHashInList(List L, string key, size_t sizeKey, int value, uint32_t hash);
+
+/**
+ * @brief Deletes a given cell from a linked list
+ *
+ * The cells are compared by address, so that no key comparison is needed.
+ *
+ * @param L Pointer to the linked list
+ * @param cell Cell to delete, supposed to be in the list
+ *
+ * @return A pointer to the modified linked list
+ */
+List delCellInList(List L, Cell *cell);
+
+/**
+ * @brief Unlinks a given cell from a linked list, without freeing it
+ *
+ * @param L Pointer to the linked list
+ * @param cell Cell to unlink, supposed to be in the list
+ *
+ * @return A pointer to the modified linked list
+ */
+List unlinkCellInList(List L, Cell *cell);
+
 
 #endif
 /* LIST_H_INCLUDED */
@@ -0,0 +1,305 @@
+/**
+ * @file concurrentqueue.c
+ * @brief Source file for bounded queues shared by several threads
+ *
+ * The positions are never reduced modulo the capacity: they are counters
+ * of size_t that only increase, so that a full queue (tail - head equals
+ * the capacity) and an empty queue (tail equals head) are told apart
+ * without a wasted cell.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "concurrentqueue.h"
+
+
+/**
+ * @brief Rounds a capacity up to a power of 2, at least 2.
+ *
+ * @param capacity The wanted capacity.
+ * @return The smallest power of 2 larger than or equal to the capacity.
+ */
+static size_t concurrentQueueCapacity(size_t capacity) {
+    size_t power = 2;
+    while (power < capacity) {
+        power *= 2;
+    }
+    return power;
+}
+
+
+/**
+ * @brief Creates an empty single-producer single-consumer queue.
+ *
+ * @param capacity The number of values the queue can hold, rounded up to a power of 2.
+ * @return A pointer to the queue, to free with spscQueueDestroy.
+ */
+SpscQueue* spscQueueCreate(size_t capacity) {
+    SpscQueue* q = (SpscQueue*)aligned_alloc(CONCURRENT_QUEUE_ALIGNMENT, sizeof(SpscQueue));
+    q->capacity = concurrentQueueCapacity(capacity);
+    q->values = (int*)malloc(q->capacity * sizeof(int));
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->cachedHead = 0;
+    q->cachedTail = 0;
+    return q;
+}
+
+
+/**
+ * @brief Frees the memory used by the queue.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void spscQueueDestroy(SpscQueue* q) {
+    free(q->values);
+    free(q);
+}
+
+
+/**
+ * @brief Adds a value at the end of the queue. Only called by the producer.
+ *
+ * @param q A pointer to the queue.
+ * @param value The value to add.
+ * @return 1 if the value is added, 0 if the queue is full.
+ */
+int spscQueuePush(SpscQueue* q, int value) {
+    return spscQueuePushBatch(q, &value, 1) == 1;
+}
+
+
+/**
+ * @brief Removes the value at the front of the queue. Only called by the consumer.
+ *
+ * @param q A pointer to the queue.
+ * @param value Receives the removed value.
+ * @return 1 if a value is removed, 0 if the queue is empty.
+ */
+int spscQueuePop(SpscQueue* q, int* value) {
+    return spscQueuePopBatch(q, value, 1) == 1;
+}
+
+
+/**
+ * @brief Adds as many values of an array as possible at the end of the
+ * queue, in the order of the array. Only called by the producer.
+ *
+ * @param q A pointer to the queue.
+ * @param values The values to add.
+ * @param nbValues The number of values of the array.
+ * @return The number of values added, the first ones of the array.
+ */
+size_t spscQueuePushBatch(SpscQueue* q, const int* values, size_t nbValues) {
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    size_t nbFree = q->capacity - (tail - q->cachedHead);
+    if (nbFree < nbValues) {
+        // the copy of head is old: the consumer may have popped since
+        q->cachedHead = atomic_load_explicit(&q->head, memory_order_acquire);
+        nbFree = q->capacity - (tail - q->cachedHead);
+    }
+    if (nbValues > nbFree) {
+        nbValues = nbFree;
+    }
+    if (nbValues == 0) {
+        return 0;
+    }
+    // at most two segments: up to the end of the ring, then from its start
+    size_t index = tail & (q->capacity - 1);
+    size_t first = q->capacity - index;
+    if (first > nbValues) {
+        first = nbValues;
+    }
+    memcpy(q->values + index, values, first * sizeof(int));
+    memcpy(q->values, values + first, (nbValues - first) * sizeof(int));
+    atomic_store_explicit(&q->tail, tail + nbValues, memory_order_release);
+    return nbValues;
+}
+
+
+/**
+ * @brief Removes up to nbValues values from the front of the queue.
+ * Only called by the consumer.
+ *
+ * @param q A pointer to the queue.
+ * @param values Array of at least nbValues values, that receives the removed values.
+ * @param nbValues The largest number of values to remove.
+ * @return The number of values removed.
+ */
+size_t spscQueuePopBatch(SpscQueue* q, int* values, size_t nbValues) {
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    size_t nbFull = q->cachedTail - head;
+    if (nbFull < nbValues) {
+        // the copy of tail is old: the producer may have pushed since
+        q->cachedTail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        nbFull = q->cachedTail - head;
+    }
+    if (nbValues > nbFull) {
+        nbValues = nbFull;
+    }
+    if (nbValues == 0) {
+        return 0;
+    }
+    size_t index = head & (q->capacity - 1);
+    size_t first = q->capacity - index;
+    if (first > nbValues) {
+        first = nbValues;
+    }
+    memcpy(values, q->values + index, first * sizeof(int));
+    memcpy(values + first, q->values, (nbValues - first) * sizeof(int));
+    atomic_store_explicit(&q->head, head + nbValues, memory_order_release);
+    return nbValues;
+}
+
+
+/**
+ * @brief Creates an empty multi-producer multi-consumer queue.
+ *
+ * @param capacity The number of values the queue can hold, rounded up to a power of 2.
+ * @return A pointer to the queue, to free with mpmcQueueDestroy.
+ */
+MpmcQueue* mpmcQueueCreate(size_t capacity) {
+    MpmcQueue* q = (MpmcQueue*)aligned_alloc(CONCURRENT_QUEUE_ALIGNMENT, sizeof(MpmcQueue));
+    q->capacity = concurrentQueueCapacity(capacity);
+    q->cells = (MpmcCell*)malloc(q->capacity * sizeof(MpmcCell));
+    for (size_t i = 0; i < q->capacity; i++) {
+        atomic_init(&q->cells[i].sequence, i);
+        q->cells[i].value = 0;
+    }
+    atomic_init(&q->enqueuePos, 0);
+    atomic_init(&q->dequeuePos, 0);
+    return q;
+}
+
+
+/**
+ * @brief Frees the memory used by the queue. No other thread may use
+ * the queue during and after the call.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void mpmcQueueDestroy(MpmcQueue* q) {
+    free(q->cells);
+    free(q);
+}
+
+
+/**
+ * @brief Claims up to nbCells consecutive cells whose sequence is the
+ * position plus offset, by moving the given position past them.
+ *
+ * The cells are checked before the compare-and-swap: a cell whose sequence
+ * is position+offset can only be used by the thread that claims this
+ * position, so it is still ready if the compare-and-swap succeeds.
+ *
+ * @param q A pointer to the queue.
+ * @param position The position to move, enqueuePos or dequeuePos.
+ * @param offset 0 to claim free cells, 1 to claim full cells.
+ * @param nbCells The largest number of cells to claim.
+ * @param first Receives the first position claimed.
+ * @return The number of cells claimed, 0 if the first cell is not ready.
+ */
+static size_t mpmcQueueClaim(MpmcQueue* q, _Atomic size_t* position, size_t offset,
+                             size_t nbCells, size_t* first) {
+    if (nbCells == 0) {
+        return 0;
+    }
+    size_t mask = q->capacity - 1;
+    size_t pos = atomic_load_explicit(position, memory_order_relaxed);
+    for (;;) {
+        size_t nbReady = 0;
+        while (nbReady < nbCells) {
+            size_t sequence = atomic_load_explicit(&q->cells[(pos + nbReady) & mask].sequence,
+                                                   memory_order_acquire);
+            if (sequence != pos + nbReady + offset) {
+                break;
+            }
+            nbReady++;
+        }
+        if (nbReady == 0) {
+            size_t sequence = atomic_load_explicit(&q->cells[pos & mask].sequence, memory_order_acquire);
+            if ((intptr_t)(sequence - (pos + offset)) < 0) {
+                // the cell is still used by the previous lap: full (or empty) queue
+                return 0;
+            }
+            // another thread has claimed the position
+            pos = atomic_load_explicit(position, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(position, &pos, pos + nbReady,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            *first = pos;
+            return nbReady;
+        }
+    }
+}
+
+
+/**
+ * @brief Adds a value at the end of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param value The value to add.
+ * @return 1 if the value is added, 0 if the queue is full.
+ */
+int mpmcQueuePush(MpmcQueue* q, int value) {
+    return mpmcQueuePushBatch(q, &value, 1) == 1;
+}
+
+
+/**
+ * @brief Removes the value at the front of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param value Receives the removed value.
+ * @return 1 if a value is removed, 0 if the queue is empty.
+ */
+int mpmcQueuePop(MpmcQueue* q, int* value) {
+    return mpmcQueuePopBatch(q, value, 1) == 1;
+}
+
+
+/**
+ * @brief Adds as many values of an array as possible at the end of the
+ * queue. The values of a batch take consecutive positions, so that no
+ * value of another producer comes between them.
+ *
+ * @param q A pointer to the queue.
+ * @param values The values to add.
+ * @param nbValues The number of values of the array.
+ * @return The number of values added, the first ones of the array.
+ */
+size_t mpmcQueuePushBatch(MpmcQueue* q, const int* values, size_t nbValues) {
+    size_t pos;
+    size_t nbClaimed = mpmcQueueClaim(q, &q->enqueuePos, 0, nbValues, &pos);
+    for (size_t i = 0; i < nbClaimed; i++) {
+        MpmcCell* cell = &q->cells[(pos + i) & (q->capacity - 1)];
+        cell->value = values[i];
+        atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+    }
+    return nbClaimed;
+}
+
+
+/**
+ * @brief Removes up to nbValues consecutive values from the front of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param values Array of at least nbValues values, that receives the removed values.
+ * @param nbValues The largest number of values to remove.
+ * @return The number of values removed.
+ */
+size_t mpmcQueuePopBatch(MpmcQueue* q, int* values, size_t nbValues) {
+    size_t pos;
+    size_t nbClaimed = mpmcQueueClaim(q, &q->dequeuePos, 1, nbValues, &pos);
+    for (size_t i = 0; i < nbClaimed; i++) {
+        MpmcCell* cell = &q->cells[(pos + i) & (q->capacity - 1)];
+        values[i] = cell->value;
+        // the cell is free for the position of the next lap
+        atomic_store_explicit(&cell->sequence, pos + i + q->capacity, memory_order_release);
+    }
+    return nbClaimed;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file concurrentqueue.h
+ * @brief Header file for bounded queues shared by several threads
+ *
+ * This file contains the declaration of two bounded queues of integers,
+ * made to connect the threads of a pipeline without any lock:
+ * - a SpscQueue has exactly one producer thread and one consumer thread,
+ * - a MpmcQueue has any number of producer and consumer threads (queue of
+ *   Dmitry Vyukov: each cell has a sequence number that tells whether it
+ *   is free or full for the current lap of the ring).
+ * Both never allocate memory after their creation: a push fails when the
+ * queue is full and a pop fails when it is empty, and the caller decides
+ * whether to retry, to yield or to do something else. Both also push and
+ * pop batches of values, which pay the synchronization once per batch.
+ */
+
+
+#ifndef CONCURRENTQUEUE_H_
+#define CONCURRENTQUEUE_H_
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Size of a cache line. The positions of the producers and of the
+ * consumers are on different cache lines, so that they do not slow each other.
+ */
+#define CONCURRENT_QUEUE_ALIGNMENT 64
+
+/**
+ * @brief Definition of a single-producer single-consumer queue
+ *
+ * The values are in the ring [values], from the position [head] (next
+ * value to pop) to the position [tail] (next free cell); the positions
+ * only increase, and the cell of a position is position & (capacity-1).
+ * Only the producer writes [tail] and only the consumer writes [head].
+ * Each thread keeps a copy of the position of the other one, and reads
+ * the shared position again only when its copy says the queue is full
+ * (producer) or empty (consumer).
+ */
+typedef struct spscQueue{
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) _Atomic size_t head; /**< Position of the next value to pop, written by the consumer */
+    size_t cachedTail; /**< Last value of tail read by the consumer */
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) _Atomic size_t tail; /**< Position of the next free cell, written by the producer */
+    size_t cachedHead; /**< Last value of head read by the producer */
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) size_t capacity; /**< Number of cells, a power of 2 */
+    int *values; /**< Ring of the values */
+} SpscQueue;
+
+/**
+ * @brief Definition of a cell of a MpmcQueue
+ *
+ * The cell of the position p is free for the producer of p when its
+ * sequence is p, and full for the consumer of p when its sequence is p+1.
+ * The consumer sets it to p+capacity, the position of the next lap.
+ */
+typedef struct mpmcCell{
+    _Atomic size_t sequence; /**< Sequence number of the cell */
+    int value; /**< Value of the cell */
+} MpmcCell;
+
+/**
+ * @brief Definition of a multi-producer multi-consumer queue
+ *
+ * A producer claims the position [enqueuePos] by a compare-and-swap, then
+ * writes the value and publishes it with the sequence of the cell; a
+ * consumer does the same with [dequeuePos].
+ */
+typedef struct mpmcQueue{
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) _Atomic size_t enqueuePos; /**< Next position to claim by a producer */
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) _Atomic size_t dequeuePos; /**< Next position to claim by a consumer */
+    _Alignas(CONCURRENT_QUEUE_ALIGNMENT) size_t capacity; /**< Number of cells, a power of 2 */
+    MpmcCell *cells; /**< Ring of the cells */
+} MpmcQueue;
+
+
+/**
+ * @brief Creates an empty single-producer single-consumer queue.
+ *
+ * @param capacity The number of values the queue can hold, rounded up to a power of 2.
+ * @return A pointer to the queue, to free with spscQueueDestroy.
+ */
+SpscQueue* spscQueueCreate(size_t capacity);
+
+/**
+ * @brief Frees the memory used by the queue.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void spscQueueDestroy(SpscQueue* q);
+
+/**
+ * @brief Adds a value at the end of the queue. Only called by the producer.
+ *
+ * @param q A pointer to the queue.
+ * @param value The value to add.
+ * @return 1 if the value is added, 0 if the queue is full.
+ */
+int spscQueuePush(SpscQueue* q, int value);
+
+/**
+ * @brief Removes the value at the front of the queue. Only called by the consumer.
+ *
+ * @param q A pointer to the queue.
+ * @param value Receives the removed value.
+ * @return 1 if a value is removed, 0 if the queue is empty.
+ */
+int spscQueuePop(SpscQueue* q, int* value);
+
+/**
+ * @brief Adds as many values of an array as possible at the end of the
+ * queue, in the order of the array. Only called by the producer.
+ *
+ * @param q A pointer to the queue.
+ * @param values The values to add.
+ * @param nbValues The number of values of the array.
+ * @return The number of values added, the first ones of the array.
+ */
+size_t spscQueuePushBatch(SpscQueue* q, const int* values, size_t nbValues);
+
+/**
+ * @brief Removes up to nbValues values from the front of the queue.
+ * Only called by the consumer.
+ *
+ * @param q A pointer to the queue.
+ * @param values Array of at least nbValues values, that receives the removed values.
+ * @param nbValues The largest number of values to remove.
+ * @return The number of values removed.
+ */
+size_t spscQueuePopBatch(SpscQueue* q, int* values, size_t nbValues);
+
+/**
+ * @brief Creates an empty multi-producer multi-consumer queue.
+ *
+ * @param capacity The number of values the queue can hold, rounded up to a power of 2.
+ * @return A pointer to the queue, to free with mpmcQueueDestroy.
+ */
+MpmcQueue* mpmcQueueCreate(size_t capacity);
+
+/**
+ * @brief Frees the memory used by the queue. No other thread may use
+ * the queue during and after the call.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void mpmcQueueDestroy(MpmcQueue* q);
+
+/**
+ * @brief Adds a value at the end of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param value The value to add.
+ * @return 1 if the value is added, 0 if the queue is full.
+ */
+int mpmcQueuePush(MpmcQueue* q, int value);
+
+/**
+ * @brief Removes the value at the front of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param value Receives the removed value.
+ * @return 1 if a value is removed, 0 if the queue is empty.
+ */
+int mpmcQueuePop(MpmcQueue* q, int* value);
+
+/**
+ * @brief Adds as many values of an array as possible at the end of the
+ * queue. The values of a batch take consecutive positions, so that no
+ * value of another producer comes between them.
+ *
+ * @param q A pointer to the queue.
+ * @param values The values to add.
+ * @param nbValues The number of values of the array.
+ * @return The number of values added, the first ones of the array.
+ */
+size_t mpmcQueuePushBatch(MpmcQueue* q, const int* values, size_t nbValues);
+
+/**
+ * @brief Removes up to nbValues consecutive values from the front of the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param values Array of at least nbValues values, that receives the removed values.
+ * @param nbValues The largest number of values to remove.
+ * @return The number of values removed.
+ */
+size_t mpmcQueuePopBatch(MpmcQueue* q, int* values, size_t nbValues);
+
+#endif // CONCURRENTQUEUE_H_
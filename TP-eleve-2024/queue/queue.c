@@ -1,21 +1,71 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "queue.h"
-#include "../list/list.h"
 
 /**
  * @brief Creates a new, empty queue.
  *
- * @return A pointer to the newly created queue.
+ * @return A pointer to the newly created queue, to free with destroyQueue.
  */
  Queue* createQueue() {
      Queue* q = (Queue*)malloc(sizeof(Queue));
-     q->front = NULL;
-     q->rear = NULL;
+     q->values = (int*)malloc(QUEUE_INITIAL_CAPACITY * sizeof(int));
+     q->capacity = QUEUE_INITIAL_CAPACITY;
+     q->front = 0;
+     q->size = 0;
      return q;
 }
 
 
+/**
+ * @brief Frees the memory used by the queue and by its elements.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void destroyQueue(Queue* q) {
+    free(q->values);
+    free(q);
+}
+
+
+/**
+ * @brief Moves the elements of the queue into a new array of the given capacity.
+ *
+ * The elements are copied in order, the front element at index 0.
+ *
+ * @param q A pointer to the queue.
+ * @param capacity The new capacity, at least the size of the queue.
+ */
+static void queueResize(Queue* q, int capacity) {
+    int* values = (int*)malloc(capacity * sizeof(int));
+    /* the elements from front to the end of the array, then the wrapped ones */
+    int firstPart = q->capacity - q->front;
+    if (firstPart > q->size) {
+        firstPart = q->size;
+    }
+    memcpy(values, q->values + q->front, firstPart * sizeof(int));
+    memcpy(values + firstPart, q->values, (q->size - firstPart) * sizeof(int));
+    free(q->values);
+    q->values = values;
+    q->capacity = capacity;
+    q->front = 0;
+}
+
+
+/**
+ * @brief Makes room for capacity elements in the queue.
+ *
+ * @param q A pointer to the queue.
+ * @param capacity The number of elements the queue must be able to hold.
+ */
+void queueReserve(Queue* q, int capacity) {
+    if (capacity > q->capacity) {
+        queueResize(q, capacity);
+    }
+}
+
+
 /**
  * @brief Checks whether the queue is empty.
  *
@@ -23,7 +73,7 @@
  * @return 1 if the queue is empty, 0 otherwise.
  */
 int isQueueEmpty(Queue q) {
-    if (q.front == NULL) {
+    if (q.size == 0) {
         return 1;
     }
     return 0;
@@ -41,13 +91,11 @@ void queuePrint(Queue q) {
     }
     else {
         printf("[");
-        Cell* temp = q.front;
-        while (temp != NULL) {
-            printf("%d", temp->value);
-            if (temp->nextCell != NULL) {
+        for (int i = 0; i < q.size; i++) {
+            printf("%d", q.values[(q.front + i) % q.capacity]);
+            if (i < q.size - 1) {
                 printf(",");
             }
-            temp = temp->nextCell;
         }
         printf("]\n");
     }
@@ -61,16 +109,15 @@ void queuePrint(Queue q) {
  * @param data The data to be added to the queue.
  */
 void enqueue(Queue* q, int data) {
-    Cell* newCell = (Cell*)malloc(sizeof(Cell));
-    newCell->value = data;
-    newCell->nextCell = NULL;
-    if (isQueueEmpty(*q)) {
-        q->front = newCell;
-        q->rear = newCell;
-    } else {
-        q->rear->nextCell = newCell;
-        q->rear = newCell;
+    if (q->size == q->capacity) {
+        queueResize(q, 2 * q->capacity);
+    }
+    int rear = q->front + q->size;
+    if (rear >= q->capacity) {
+        rear -= q->capacity;
     }
+    q->values[rear] = data;
+    q->size++;
 }
 
 /**
@@ -84,10 +131,12 @@ int dequeue(Queue* q) {
         printf("Error: queue is empty\n");
         return -1;
     }
-    int value= q->front->value;
-    Cell* temp = q->front;
-    q->front = q->front->nextCell;
-    free(temp);
+    int value = q->values[q->front];
+    q->front++;
+    if (q->front == q->capacity) {
+        q->front = 0;
+    }
+    q->size--;
     return value;
 
 }
@@ -104,5 +153,5 @@ int queueGetFrontValue(Queue q) {
         printf("Error: queue is empty\n");
         return -1;
     }
-    return q.front->value;
+    return q.values[q.front];
 }
@@ -1,26 +1,55 @@
-#ifndef LINKED_QUEUE_H_
-#define LINKED_QUEUE_H_
+#ifndef QUEUE_H_
+#define QUEUE_H_
 
 #include <stdlib.h>
-#include "../list/list.h"
 
+/**
+ * @brief Initial capacity of a queue created by createQueue
+ */
+#define QUEUE_INITIAL_CAPACITY 16
 
 /**
- * @brief A queue structure based on a linked list.
+ * @brief A queue structure based on a circular array.
  *
+ * The elements are stored in the array values, from the index front
+ * (the first element) to the index (front+size-1) modulo capacity (the
+ * last element), wrapping around the end of the array. When the array is
+ * full, its capacity is doubled, so that an enqueue takes an amortized
+ * constant time and no memory is allocated for each element.
  */
 typedef struct queue {
-    Cell* front; /** A pointer to the front (first) element in the queue. */
-    Cell* rear; /** A pointer to the rear (last) element in the queue. */
+    int* values; /** The circular array of the elements. */
+    int capacity; /** The number of elements the array can hold. */
+    int front; /** The index of the front (first) element in the array. */
+    int size; /** The number of elements in the queue. */
 } Queue;
 
 /**
  * @brief Creates a new, empty queue.
  *
- * @return A pointer to the newly created queue.
+ * @return A pointer to the newly created queue, to free with destroyQueue.
  */
 Queue* createQueue();
 
+/**
+ * @brief Frees the memory used by the queue and by its elements.
+ *
+ * @param q A pointer to the queue to free.
+ */
+void destroyQueue(Queue* q);
+
+/**
+ * @brief Makes room for capacity elements in the queue.
+ *
+ * The queue can then hold capacity elements without any reallocation,
+ * for example before a breadth first search where each vertex is
+ * added at most once. The capacity is never decreased.
+ *
+ * @param q A pointer to the queue.
+ * @param capacity The number of elements the queue must be able to hold.
+ */
+void queueReserve(Queue* q, int capacity);
+
 /**
  * @brief Prints all the elements in the queue, from front to rear.
  *
@@ -60,4 +89,4 @@ int isQueueEmpty(Queue q);
  */
 int queueGetFrontValue(Queue q);
 
-#endif /* LINKED_QUEUE_H_ */
+#endif /* QUEUE_H_ */
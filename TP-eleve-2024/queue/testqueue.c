@@ -1,6 +1,121 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
 #include "queue.h"
+#include "concurrentqueue.h"
+
+#define BENCHMARK_NB_VALUES 2000000
+#define BENCHMARK_CAPACITY 1024
+
+/**
+ * @brief Work of a thread of the benchmark of the concurrent queues
+ */
+typedef struct queueWork {
+    SpscQueue* spsc; /** The SPSC queue, NULL to use the MPMC queue. */
+    MpmcQueue* mpmc; /** The MPMC queue. */
+    int nbValues; /** The number of values to push or to pop. */
+    int batchSize; /** The number of values per push or pop. */
+    int first; /** The first value pushed by a producer. */
+    long long sum; /** The sum of the values popped by a consumer. */
+} QueueWork;
+
+/**
+ * @brief Pushes the values first..first+nbValues-1, by batches.
+ */
+static void* producerWorker(void* arg) {
+    QueueWork* work = (QueueWork*)arg;
+    int* batch = (int*)malloc(work->batchSize * sizeof(int));
+    int nbPushed = 0;
+    while (nbPushed < work->nbValues) {
+        int size = work->nbValues - nbPushed < work->batchSize ? work->nbValues - nbPushed : work->batchSize;
+        for (int i = 0; i < size; i++) {
+            batch[i] = work->first + nbPushed + i;
+        }
+        int done = 0;
+        while (done < size) {
+            size_t n = work->spsc != NULL
+                ? spscQueuePushBatch(work->spsc, batch + done, size - done)
+                : mpmcQueuePushBatch(work->mpmc, batch + done, size - done);
+            if (n == 0) {
+                sched_yield();
+            }
+            done += n;
+        }
+        nbPushed += size;
+    }
+    free(batch);
+    return NULL;
+}
+
+/**
+ * @brief Pops nbValues values, by batches, and sums them.
+ */
+static void* consumerWorker(void* arg) {
+    QueueWork* work = (QueueWork*)arg;
+    int* batch = (int*)malloc(work->batchSize * sizeof(int));
+    int nbPopped = 0;
+    work->sum = 0;
+    while (nbPopped < work->nbValues) {
+        int size = work->nbValues - nbPopped < work->batchSize ? work->nbValues - nbPopped : work->batchSize;
+        size_t n = work->spsc != NULL
+            ? spscQueuePopBatch(work->spsc, batch, size)
+            : mpmcQueuePopBatch(work->mpmc, batch, size);
+        if (n == 0) {
+            sched_yield();
+        }
+        for (size_t i = 0; i < n; i++) {
+            work->sum += batch[i];
+        }
+        nbPopped += n;
+    }
+    free(batch);
+    return NULL;
+}
+
+/**
+ * @brief Passes BENCHMARK_NB_VALUES values from nbPairs producers to
+ * nbPairs consumers, and prints the number of values per second.
+ */
+static void benchmarkConcurrentQueue(int mpmc, int nbPairs, int batchSize) {
+    SpscQueue* spsc = mpmc ? NULL : spscQueueCreate(BENCHMARK_CAPACITY);
+    MpmcQueue* queue = mpmc ? mpmcQueueCreate(BENCHMARK_CAPACITY) : NULL;
+    QueueWork* works = (QueueWork*)malloc(2 * nbPairs * sizeof(QueueWork));
+    pthread_t* threads = (pthread_t*)malloc(2 * nbPairs * sizeof(pthread_t));
+    int nbValues = BENCHMARK_NB_VALUES / nbPairs;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int t = 0; t < 2 * nbPairs; t++) {
+        works[t].spsc = spsc;
+        works[t].mpmc = queue;
+        works[t].nbValues = nbValues;
+        works[t].batchSize = batchSize;
+        works[t].first = (t / 2) * nbValues;
+        pthread_create(&threads[t], NULL, t % 2 == 0 ? producerWorker : consumerWorker, &works[t]);
+    }
+    long long sum = 0;
+    for (int t = 0; t < 2 * nbPairs; t++) {
+        pthread_join(threads[t], NULL);
+        if (t % 2 == 1) {
+            sum += works[t].sum;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double time = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    long long total = (long long)nbValues * nbPairs;
+    printf("%s, %d producer(s) + %d consumer(s), batches of %2d: %10.0f ops/s %s\n",
+           mpmc ? "MPMC" : "SPSC", nbPairs, nbPairs, batchSize, total / time,
+           sum == total * (total - 1) / 2 ? "" : "(wrong values)");
+    free(threads);
+    free(works);
+    if (spsc != NULL) {
+        spscQueueDestroy(spsc);
+    }
+    if (queue != NULL) {
+        mpmcQueueDestroy(queue);
+    }
+}
 
 int main() {
     Queue* q = createQueue();
@@ -56,8 +171,41 @@ int main() {
 
     // Check if the queue is empty
     printf("\nIs queue empty? %d\n", isQueueEmpty(*q));
-    
-    free(q);
+
+    // Many elements, with the front moving around the array while it grows
+    int nbErrors = 0;
+    int next = 0;
+    for (int i = 0; i < 1000000; i++) {
+        enqueue(q, i);
+        if (i % 3 == 0 && dequeue(q) != next++) {
+            nbErrors++;
+        }
+    }
+    while (!isQueueEmpty(*q)) {
+        if (dequeue(q) != next++) {
+            nbErrors++;
+        }
+    }
+    printf("\n1000000 elements: %d errors, capacity %d\n", nbErrors, q->capacity);
+
+    // Reserved capacity: no reallocation
+    queueReserve(q, 5000000);
+    int *values = q->values;
+    for (int i = 0; i < 5000000; i++) {
+        enqueue(q, i);
+    }
+    printf("5000000 elements after queueReserve: %s\n", values == q->values ? "no reallocation" : "reallocated");
+
+    destroyQueue(q);
+
+    // Queues shared by threads
+    printf("\n");
+    benchmarkConcurrentQueue(0, 1, 1);
+    benchmarkConcurrentQueue(0, 1, 64);
+    for (int nbPairs = 1; nbPairs <= 4; nbPairs *= 2) {
+        benchmarkConcurrentQueue(1, nbPairs, 1);
+        benchmarkConcurrentQueue(1, nbPairs, 64);
+    }
 
     return 0;
 }
@@ -5,20 +5,45 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "stack.h"
-#include "../list/list.h"
 
 /**
  * @brief Creates a new stack with no elements.
  *
- * @return A pointer to the new stack.
+ * @return A pointer to the new stack, to free with destroyStack.
  */
 Stack* createStack() {
-    Stack* s=malloc(sizeof(Stack)); 
-    *s=newList();
+    Stack* s = (Stack*)malloc(sizeof(Stack));
+    s->values = (int*)malloc(STACK_INITIAL_CAPACITY * sizeof(int));
+    s->capacity = STACK_INITIAL_CAPACITY;
+    s->size = 0;
     return s;
 }
 
+/**
+ * @brief Frees the memory used by the stack and by its elements.
+ *
+ * @param stack A pointer to the stack to free.
+ */
+void destroyStack(Stack* stack) {
+    free(stack->values);
+    free(stack);
+}
+
+/**
+ * @brief Makes room for capacity elements in the stack.
+ *
+ * @param stack A pointer to the stack.
+ * @param capacity The number of elements the stack must be able to hold.
+ */
+void stackReserve(Stack* stack, int capacity) {
+    if (capacity > stack->capacity) {
+        stack->values = (int*)realloc(stack->values, capacity * sizeof(int));
+        stack->capacity = capacity;
+    }
+}
+
 /**
  * @brief Pushes an element onto the top of the stack.
  *
@@ -26,20 +51,31 @@ Stack* createStack() {
  * @param data The data to push onto the stack.
  */
 void push(Stack* stack, int data) {
-
-    Cell* newCell = (Cell*)malloc(sizeof(Cell));
-    if (newCell == NULL) {
-        // Gestion d'erreur en cas d'échec d'allocation
-        return;
+    if (stack->size == stack->capacity) {
+        stackReserve(stack, 2 * stack->capacity);
     }
+    stack->values[stack->size] = data;
+    stack->size++;
+}
 
-    newCell->value = data;
-    newCell->nextCell = *stack; 
-    *stack = newCell; 
-
-
-
-    
+/**
+ * @brief Pushes the elements of an array onto the top of the stack, in
+ * the order of the array: the last element of the array is on top.
+ *
+ * @param stack The stack to push onto.
+ * @param data The array of the data to push onto the stack.
+ * @param nbData The number of elements of the array.
+ */
+void pushArray(Stack* stack, const int* data, int nbData) {
+    if (stack->size + nbData > stack->capacity) {
+        int capacity = 2 * stack->capacity;
+        while (capacity < stack->size + nbData) {
+            capacity *= 2;
+        }
+        stackReserve(stack, capacity);
+    }
+    memcpy(stack->values + stack->size, data, nbData * sizeof(int));
+    stack->size += nbData;
 }
 
 /**
@@ -47,12 +83,15 @@ void push(Stack* stack, int data) {
  *
  * @param stack The stack to pop from.
  *
- * @return The data from the top element of the stack.
+ * @return The data from the top element of the stack, -1 if the stack is empty.
  */
 int pop(Stack* stack) {
-    int value=(*stack)->value;
-    (*stack)=(*stack)->nextCell;
-    return value;
+    if (isStackEmpty(*stack)) {
+        printf("Error: stack is empty\n");
+        return -1;
+    }
+    stack->size--;
+    return stack->values[stack->size];
 }
 
 /**
@@ -60,11 +99,14 @@ int pop(Stack* stack) {
  *
  * @param stack The stack to peek at.
  *
- * @return The data from the top element of the stack.
+ * @return The data from the top element of the stack, -1 if the stack is empty.
  */
 int peek(Stack stack) {
-
-    return stack->value;
+    if (isStackEmpty(stack)) {
+        printf("Error: stack is empty\n");
+        return -1;
+    }
+    return stack.values[stack.size - 1];
 }
 
 /**
@@ -75,17 +117,24 @@ int peek(Stack stack) {
  * @return 1 if the stack is empty, 0 otherwise.
  */
 int isStackEmpty(Stack stack) {
-    if(stack==NULL)
+    if (stack.size == 0) {
         return 1;
+    }
     return 0;
 }
 
 /**
- * @brief Prints the contents of the stack to stdout.
+ * @brief Prints the contents of the stack to stdout, from the top to the bottom.
  *
  * @param stack The stack to print.
  */
 void stackPrint(Stack stack) {
-    int type=0;
-    printList(stack,type);
+    printf("[");
+    for (int i = stack.size - 1; i >= 0; i--) {
+        printf("%d", stack.values[i]);
+        if (i > 0) {
+            printf(",");
+        }
+    }
+    printf("]");
 }
@@ -5,21 +5,54 @@
 
 #ifndef STACK_H
 #define STACK_H
-#include "../list/list.h"
+
+#include <stdlib.h>
 
 /**
- * @brief The Stack data structure. It is only a list.
+ * @brief Initial capacity of a stack created by createStack
  */
+#define STACK_INITIAL_CAPACITY 16
 
-typedef List Stack;
+/**
+ * @brief The Stack data structure, based on a growable array.
+ *
+ * The elements are stored in the array values, from the bottom of the
+ * stack at index 0 to the top at index size-1. When the array is full,
+ * its capacity is doubled: a push takes an amortized constant time, and
+ * a pop never calls the allocator.
+ */
+typedef struct stack {
+    int* values; /** The array of the elements. */
+    int capacity; /** The number of elements the array can hold. */
+    int size; /** The number of elements in the stack. */
+} Stack;
 
 /**
  * @brief Creates a new stack with no elements.
  *
- * @return A pointer to the new stack.
+ * @return A pointer to the new stack, to free with destroyStack.
  */
 Stack* createStack();
 
+/**
+ * @brief Frees the memory used by the stack and by its elements.
+ *
+ * @param stack A pointer to the stack to free.
+ */
+void destroyStack(Stack* stack);
+
+/**
+ * @brief Makes room for capacity elements in the stack.
+ *
+ * The stack can then hold capacity elements without any reallocation,
+ * for example before a depth first search where each vertex is pushed
+ * at most once. The capacity is never decreased.
+ *
+ * @param stack A pointer to the stack.
+ * @param capacity The number of elements the stack must be able to hold.
+ */
+void stackReserve(Stack* stack, int capacity);
+
 /**
  * @brief Pushes an element onto the top of the stack.
  *
@@ -28,12 +61,22 @@ Stack* createStack();
  */
 void push(Stack* stack, int data);
 
+/**
+ * @brief Pushes the elements of an array onto the top of the stack, in
+ * the order of the array: the last element of the array is on top.
+ *
+ * @param stack The stack to push onto.
+ * @param data The array of the data to push onto the stack.
+ * @param nbData The number of elements of the array.
+ */
+void pushArray(Stack* stack, const int* data, int nbData);
+
 /**
  * @brief Pops an element from the top of the stack.
  *
  * @param stack The stack to pop from.
  *
- * @return The data from the top element of the stack.
+ * @return The data from the top element of the stack, -1 if the stack is empty.
  */
 int pop(Stack* stack);
 
@@ -42,7 +85,7 @@ int pop(Stack* stack);
  *
  * @param stack The stack to peek at.
  *
- * @return The data from the top element of the stack.
+ * @return The data from the top element of the stack, -1 if the stack is empty.
  */
 int peek(Stack stack);
 
@@ -56,7 +99,7 @@ int peek(Stack stack);
 int isStackEmpty(Stack stack);
 
 /**
- * @brief Prints the contents of the stack to stdout.
+ * @brief Prints the contents of the stack to stdout, from the top to the bottom.
  *
  * @param stack The stack to print.
  */
@@ -1,6 +1,50 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
 #include "stack.h"
+#include "workstealing.h"
+
+#define STEAL_NB_VALUES 1000000
+#define STEAL_NB_THIEVES 3
+#define TREE_NB_TASKS 2000000
+
+/**
+ * @brief Data shared by the owner and the thieves of a deque
+ */
+typedef struct stealWork {
+    WorkDeque* deque; /** The deque. */
+    _Atomic int* counts; /** The number of times each value was received. */
+    _Atomic int done; /** 1 when the owner has received all its values. */
+} StealWork;
+
+/**
+ * @brief Steals values from the deque until the owner is done.
+ */
+static void* thiefWorker(void* arg) {
+    StealWork* work = (StealWork*)arg;
+    int value;
+    while (!atomic_load(&work->done)) {
+        if (workDequeSteal(work->deque, &value) == 1) {
+            atomic_fetch_add(&work->counts[value], 1);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Task of a binary tree: the task t spawns the tasks 2t+1 and 2t+2.
+ */
+static void treeTask(Scheduler* scheduler, int worker, int task) {
+    _Atomic int* counts = (_Atomic int*)scheduler->context;
+    atomic_fetch_add_explicit(&counts[task], 1, memory_order_relaxed);
+    if (2 * task + 1 < TREE_NB_TASKS) {
+        schedulerSpawn(scheduler, worker, 2 * task + 1);
+    }
+    if (2 * task + 2 < TREE_NB_TASKS) {
+        schedulerSpawn(scheduler, worker, 2 * task + 2);
+    }
+}
 
 int main() {
     Stack* s = createStack() ;
@@ -54,7 +98,102 @@ int main() {
     // Check if the stack is empty
     printf("\nIs stack empty? %d\n", isStackEmpty(*s));
     
-    free(s);
+    // Bulk push: the last element of the array is on top
+    int values[5] = {10, 20, 30, 40, 50};
+    pushArray(s, values, 5);
+    printf("\nAfter pushing [10,20,30,40,50]:\n");
+    stackPrint(*s);
+    printf("\n");
+
+    // Many elements, with the array growing
+    int nbErrors = 0;
+    for (int i = 0; i < 1000000; i++) {
+        push(s, i);
+    }
+    for (int i = 999999; i >= 0; i--) {
+        if (pop(s) != i) {
+            nbErrors++;
+        }
+    }
+    printf("\n1000000 elements: %d errors, capacity %d\n", nbErrors, s->capacity);
+
+    // Reserved capacity: no reallocation
+    stackReserve(s, s->size + 5000000);
+    int *array = s->values;
+    for (int i = 0; i < 5000000; i++) {
+        push(s, i);
+    }
+    printf("5000000 elements after stackReserve: %s\n", array == s->values ? "no reallocation" : "reallocated");
+
+    destroyStack(s);
+
+    // Work-stealing deque: the owner takes the newest value, a thief the oldest
+    WorkDeque* deque = workDequeCreate();
+    for (int i = 0; i < 100; i++) {
+        workDequePush(deque, i);
+    }
+    int taken = -1, stolen = -1;
+    workDequeTake(deque, &taken);
+    workDequeSteal(deque, &stolen);
+    printf("\nDeque of 0..99: taken %d, stolen %d\n", taken, stolen);
+    while (workDequeTake(deque, &taken)) {
+    }
+
+    // Owner and thieves at the same time: each value must be received once
+    StealWork work;
+    work.deque = deque;
+    work.counts = (_Atomic int*)calloc(STEAL_NB_VALUES, sizeof(_Atomic int));
+    atomic_init(&work.done, 0);
+    pthread_t thieves[STEAL_NB_THIEVES];
+    for (int t = 0; t < STEAL_NB_THIEVES; t++) {
+        pthread_create(&thieves[t], NULL, thiefWorker, &work);
+    }
+    for (int i = 0; i < STEAL_NB_VALUES; i++) {
+        workDequePush(deque, i);
+        if (i % 2 == 0 && workDequeTake(deque, &taken)) {
+            atomic_fetch_add(&work.counts[taken], 1);
+        }
+    }
+    while (workDequeTake(deque, &taken)) {
+        atomic_fetch_add(&work.counts[taken], 1);
+    }
+    atomic_store(&work.done, 1);
+    for (int t = 0; t < STEAL_NB_THIEVES; t++) {
+        pthread_join(thieves[t], NULL);
+    }
+    nbErrors = 0;
+    for (int i = 0; i < STEAL_NB_VALUES; i++) {
+        if (atomic_load(&work.counts[i]) != 1) {
+            nbErrors++;
+        }
+    }
+    printf("%d values with %d thieves: %d errors\n", STEAL_NB_VALUES, STEAL_NB_THIEVES, nbErrors);
+    free(work.counts);
+    workDequeDestroy(deque);
+
+    // Scheduler: a binary tree of tasks, each task must run once
+    _Atomic int* counts = (_Atomic int*)calloc(TREE_NB_TASKS, sizeof(_Atomic int));
+    for (int nbWorkers = 1; nbWorkers <= 4; nbWorkers *= 2) {
+        for (int i = 0; i < TREE_NB_TASKS; i++) {
+            atomic_init(&counts[i], 0);
+        }
+        Scheduler* scheduler = schedulerCreate(nbWorkers, treeTask, counts);
+        int root = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        schedulerRun(scheduler, &root, 1);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        nbErrors = 0;
+        for (int i = 0; i < TREE_NB_TASKS; i++) {
+            if (atomic_load(&counts[i]) != 1) {
+                nbErrors++;
+            }
+        }
+        printf("Tree of %d tasks on %d thread(s): %d errors, %f s\n", TREE_NB_TASKS, nbWorkers, nbErrors,
+               (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+        schedulerDestroy(scheduler);
+    }
+    free(counts);
 
     return 0;
 }
@@ -0,0 +1,309 @@
+/**
+ * @file workstealing.c
+ * @brief Implementation file for the work-stealing deque and its scheduler.
+ *
+ * The memory orders of the deque are those of "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (Lê, Pop, Cohen, Zappa Nardelli):
+ * the owner and a thief that want the same last element both read the
+ * index of the other after a sequentially consistent fence, and only one
+ * of them wins the compare-and-swap on top.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include "workstealing.h"
+
+/**
+ * @brief Allocates an empty circular array.
+ *
+ * @param capacity The number of elements, a power of 2.
+ * @return A pointer to the array.
+ */
+static WorkArray* workArrayCreate(long long capacity) {
+    WorkArray* array = (WorkArray*)malloc(sizeof(WorkArray) + capacity * sizeof(_Atomic int));
+    array->capacity = capacity;
+    array->previous = NULL;
+    return array;
+}
+
+/**
+ * @brief Initializes a deque with no elements.
+ *
+ * @param deque The deque to initialize.
+ */
+static void workDequeInit(WorkDeque* deque) {
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, workArrayCreate(WORKDEQUE_INITIAL_CAPACITY));
+}
+
+/**
+ * @brief Frees the arrays of a deque, the current one and the replaced ones.
+ *
+ * @param deque The deque.
+ */
+static void workDequeFreeArrays(WorkDeque* deque) {
+    WorkArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array != NULL) {
+        WorkArray* previous = array->previous;
+        free(array);
+        array = previous;
+    }
+}
+
+/**
+ * @brief Creates a new deque with no elements.
+ *
+ * @return A pointer to the new deque, to free with workDequeDestroy.
+ */
+WorkDeque* workDequeCreate() {
+    WorkDeque* deque = (WorkDeque*)aligned_alloc(WORKDEQUE_ALIGNMENT, sizeof(WorkDeque));
+    workDequeInit(deque);
+    return deque;
+}
+
+/**
+ * @brief Frees the memory used by the deque. No other thread may use
+ * the deque during and after the call.
+ *
+ * @param deque A pointer to the deque to free.
+ */
+void workDequeDestroy(WorkDeque* deque) {
+    workDequeFreeArrays(deque);
+    free(deque);
+}
+
+/**
+ * @brief Replaces the array of the deque by an array twice larger.
+ *
+ * @param deque The deque.
+ * @param array The current array of the deque.
+ * @param top The index of the oldest element.
+ * @param bottom The index after the newest element.
+ * @return The new array.
+ */
+static WorkArray* workDequeGrow(WorkDeque* deque, WorkArray* array, long long top, long long bottom) {
+    WorkArray* larger = workArrayCreate(2 * array->capacity);
+    for (long long i = top; i < bottom; i++) {
+        int value = atomic_load_explicit(&array->values[i & (array->capacity - 1)], memory_order_relaxed);
+        atomic_store_explicit(&larger->values[i & (larger->capacity - 1)], value, memory_order_relaxed);
+    }
+    // a thief may still read the old array: it is freed with the deque
+    larger->previous = array;
+    atomic_store_explicit(&deque->array, larger, memory_order_release);
+    return larger;
+}
+
+/**
+ * @brief Pushes an element at the bottom of the deque. Only called by the owner.
+ *
+ * The array is doubled when it is full.
+ *
+ * @param deque The deque to push onto.
+ * @param data The data to push.
+ */
+void workDequePush(WorkDeque* deque, int data) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    WorkArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    if (bottom - top > array->capacity - 1) {
+        array = workDequeGrow(deque, array, top, bottom);
+    }
+    atomic_store_explicit(&array->values[bottom & (array->capacity - 1)], data, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Takes the newest element, at the bottom of the deque. Only called by the owner.
+ *
+ * @param deque The deque to take from.
+ * @param data Receives the element.
+ * @return 1 if an element is taken, 0 if the deque is empty.
+ */
+int workDequeTake(WorkDeque* deque, int* data) {
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    WorkArray* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    // reserve the element before looking at top, so that a thief sees it
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (top > bottom) {
+        // the deque was empty
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return 0;
+    }
+    *data = atomic_load_explicit(&array->values[bottom & (array->capacity - 1)], memory_order_relaxed);
+    if (top < bottom) {
+        return 1;
+    }
+    // last element: the owner and the thieves race for it on top
+    int taken = atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                        memory_order_seq_cst, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    return taken;
+}
+
+/**
+ * @brief Steals the oldest element, at the top of the deque. Called by any thread.
+ *
+ * @param deque The deque to steal from.
+ * @param data Receives the element.
+ * @return 1 if an element is stolen, 0 if the deque is empty, -1 if another
+ * thread took the element first (the deque may not be empty).
+ */
+int workDequeSteal(WorkDeque* deque, int* data) {
+    long long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return 0;
+    }
+    WorkArray* array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    int value = atomic_load_explicit(&array->values[top & (array->capacity - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return -1;
+    }
+    *data = value;
+    return 1;
+}
+
+
+/**
+ * @brief Argument of a thread of a scheduler.
+ */
+typedef struct schedulerWorker {
+    Scheduler* scheduler; /** The scheduler. */
+    int worker; /** The number of the thread. */
+    unsigned int seed; /** State of the random choice of the victims. */
+} SchedulerWorker;
+
+/**
+ * @brief Creates a scheduler.
+ *
+ * @param nbWorkers The number of threads, the number of processors if it is not positive.
+ * @param function The function that runs a task.
+ * @param context Data shared by the tasks, available in scheduler->context.
+ * @return A pointer to the scheduler, to free with schedulerDestroy.
+ */
+Scheduler* schedulerCreate(int nbWorkers, TaskFunction function, void* context) {
+    if (nbWorkers <= 0) {
+        nbWorkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (nbWorkers <= 0) {
+            nbWorkers = 1;
+        }
+    }
+    Scheduler* scheduler = (Scheduler*)aligned_alloc(WORKDEQUE_ALIGNMENT, sizeof(Scheduler));
+    scheduler->nbWorkers = nbWorkers;
+    scheduler->deques = (WorkDeque*)aligned_alloc(WORKDEQUE_ALIGNMENT, nbWorkers * sizeof(WorkDeque));
+    for (int i = 0; i < nbWorkers; i++) {
+        workDequeInit(&scheduler->deques[i]);
+    }
+    scheduler->function = function;
+    scheduler->context = context;
+    atomic_init(&scheduler->nbPending, 0);
+    return scheduler;
+}
+
+/**
+ * @brief Frees the memory used by the scheduler.
+ *
+ * @param scheduler A pointer to the scheduler to free.
+ */
+void schedulerDestroy(Scheduler* scheduler) {
+    for (int i = 0; i < scheduler->nbWorkers; i++) {
+        workDequeFreeArrays(&scheduler->deques[i]);
+    }
+    free(scheduler->deques);
+    free(scheduler);
+}
+
+/**
+ * @brief Adds a task to run. Only called by a task, from the thread running it.
+ *
+ * @param scheduler The scheduler.
+ * @param worker The number of the thread running the calling task.
+ * @param task The new task.
+ */
+void schedulerSpawn(Scheduler* scheduler, int worker, int task) {
+    // counted before it can be stolen, so that nbPending never reaches 0 too early
+    atomic_fetch_add_explicit(&scheduler->nbPending, 1, memory_order_relaxed);
+    workDequePush(&scheduler->deques[worker], task);
+}
+
+/**
+ * @brief Finds a task: in the deque of the thread, else in the deque of
+ * random threads.
+ *
+ * @param worker The thread.
+ * @param task Receives the task.
+ * @return 1 if a task is found, 0 otherwise.
+ */
+static int schedulerFindTask(SchedulerWorker* worker, int* task) {
+    Scheduler* scheduler = worker->scheduler;
+    if (workDequeTake(&scheduler->deques[worker->worker], task)) {
+        return 1;
+    }
+    for (int attempt = 0; attempt < 2 * scheduler->nbWorkers; attempt++) {
+        int victim = rand_r(&worker->seed) % scheduler->nbWorkers;
+        if (victim != worker->worker && workDequeSteal(&scheduler->deques[victim], task) == 1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Loop of a thread of a scheduler: runs tasks until no task is pending.
+ *
+ * @param arg The SchedulerWorker of the thread.
+ * @return NULL
+ */
+static void* schedulerWorkerLoop(void* arg) {
+    SchedulerWorker* worker = (SchedulerWorker*)arg;
+    Scheduler* scheduler = worker->scheduler;
+    int task;
+    while (atomic_load_explicit(&scheduler->nbPending, memory_order_acquire) > 0) {
+        if (schedulerFindTask(worker, &task)) {
+            scheduler->function(scheduler, worker->worker, task);
+            // the tasks spawned by this one are already counted
+            atomic_fetch_sub_explicit(&scheduler->nbPending, 1, memory_order_release);
+        }
+        else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs tasks until all of them, and all the tasks they spawn, are finished.
+ *
+ * The first tasks are shared among the threads. The function returns
+ * when the threads are stopped, and can be called again.
+ *
+ * @param scheduler The scheduler.
+ * @param tasks The first tasks.
+ * @param nbTasks The number of first tasks.
+ */
+void schedulerRun(Scheduler* scheduler, const int* tasks, int nbTasks) {
+    for (int i = 0; i < nbTasks; i++) {
+        schedulerSpawn(scheduler, i % scheduler->nbWorkers, tasks[i]);
+    }
+    SchedulerWorker* workers = (SchedulerWorker*)malloc(scheduler->nbWorkers * sizeof(SchedulerWorker));
+    pthread_t* threads = (pthread_t*)malloc(scheduler->nbWorkers * sizeof(pthread_t));
+    for (int i = 0; i < scheduler->nbWorkers; i++) {
+        workers[i].scheduler = scheduler;
+        workers[i].worker = i;
+        workers[i].seed = 2 * i + 1;
+        pthread_create(&threads[i], NULL, schedulerWorkerLoop, &workers[i]);
+    }
+    for (int i = 0; i < scheduler->nbWorkers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    free(workers);
+}
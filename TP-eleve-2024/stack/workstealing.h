@@ -0,0 +1,163 @@
+/**
+ * @file workstealing.h
+ * @brief Header file for the work-stealing deque and its scheduler.
+ *
+ * A WorkDeque is the deque of Chase and Lev: its owner thread uses it as
+ * a stack (push and take at the bottom), while the other threads (the
+ * thieves) steal the oldest elements from the top. The owner only
+ * synchronizes with the thieves when the deque has at most one element.
+ *
+ * A Scheduler runs tasks (integers, for example vertices) on several
+ * threads, each with its own deque: a thread runs the tasks it spawns
+ * itself in depth first order, and steals from a random thread when its
+ * deque is empty.
+ */
+
+#ifndef WORKSTEALING_H
+#define WORKSTEALING_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+
+/**
+ * @brief Initial capacity of a deque created by workDequeCreate
+ */
+#define WORKDEQUE_INITIAL_CAPACITY 64
+
+/**
+ * @brief Size of a cache line, so that the top and the bottom of a deque,
+ * and the deques of two threads, are not on the same cache line.
+ */
+#define WORKDEQUE_ALIGNMENT 64
+
+/**
+ * @brief Circular array of the elements of a WorkDeque.
+ *
+ * The array is never resized: a larger array replaces it, and the old
+ * one is kept until the deque is destroyed, since a thief may still be
+ * reading it.
+ */
+typedef struct workArray {
+    long long capacity; /** The number of elements, a power of 2. */
+    struct workArray* previous; /** The array this one replaced, NULL if none. */
+    _Atomic int values[]; /** The elements, the element of index i is at i & (capacity-1). */
+} WorkArray;
+
+/**
+ * @brief The work-stealing deque of Chase and Lev.
+ *
+ * The elements are those of the indices top to bottom-1. Only the owner
+ * writes bottom and array; top is moved by a compare-and-swap, by the
+ * thieves and by the owner when it takes the last element.
+ */
+typedef struct workDeque {
+    _Alignas(WORKDEQUE_ALIGNMENT) _Atomic long long top; /** Index of the oldest element. */
+    _Alignas(WORKDEQUE_ALIGNMENT) _Atomic long long bottom; /** Index after the newest element. */
+    WorkArray* _Atomic array; /** The circular array of the elements. */
+} WorkDeque;
+
+typedef struct scheduler Scheduler;
+
+/**
+ * @brief Function that runs a task of a Scheduler.
+ *
+ * @param scheduler The scheduler, where the function can spawn new tasks.
+ * @param worker The number of the thread running the task.
+ * @param task The task to run.
+ */
+typedef void (*TaskFunction)(Scheduler* scheduler, int worker, int task);
+
+/**
+ * @brief A pool of threads that run tasks with work stealing.
+ */
+struct scheduler {
+    int nbWorkers; /** The number of threads. */
+    WorkDeque* deques; /** The deque of each thread. */
+    TaskFunction function; /** The function that runs a task. */
+    void* context; /** Data shared by the tasks, for example a graph. */
+    _Alignas(WORKDEQUE_ALIGNMENT) _Atomic long long nbPending; /** The number of tasks spawned and not finished. */
+};
+
+/**
+ * @brief Creates a new deque with no elements.
+ *
+ * @return A pointer to the new deque, to free with workDequeDestroy.
+ */
+WorkDeque* workDequeCreate();
+
+/**
+ * @brief Frees the memory used by the deque. No other thread may use
+ * the deque during and after the call.
+ *
+ * @param deque A pointer to the deque to free.
+ */
+void workDequeDestroy(WorkDeque* deque);
+
+/**
+ * @brief Pushes an element at the bottom of the deque. Only called by the owner.
+ *
+ * The array is doubled when it is full.
+ *
+ * @param deque The deque to push onto.
+ * @param data The data to push.
+ */
+void workDequePush(WorkDeque* deque, int data);
+
+/**
+ * @brief Takes the newest element, at the bottom of the deque. Only called by the owner.
+ *
+ * @param deque The deque to take from.
+ * @param data Receives the element.
+ * @return 1 if an element is taken, 0 if the deque is empty.
+ */
+int workDequeTake(WorkDeque* deque, int* data);
+
+/**
+ * @brief Steals the oldest element, at the top of the deque. Called by any thread.
+ *
+ * @param deque The deque to steal from.
+ * @param data Receives the element.
+ * @return 1 if an element is stolen, 0 if the deque is empty, -1 if another
+ * thread took the element first (the deque may not be empty).
+ */
+int workDequeSteal(WorkDeque* deque, int* data);
+
+/**
+ * @brief Creates a scheduler.
+ *
+ * @param nbWorkers The number of threads, the number of processors if it is not positive.
+ * @param function The function that runs a task.
+ * @param context Data shared by the tasks, available in scheduler->context.
+ * @return A pointer to the scheduler, to free with schedulerDestroy.
+ */
+Scheduler* schedulerCreate(int nbWorkers, TaskFunction function, void* context);
+
+/**
+ * @brief Frees the memory used by the scheduler.
+ *
+ * @param scheduler A pointer to the scheduler to free.
+ */
+void schedulerDestroy(Scheduler* scheduler);
+
+/**
+ * @brief Adds a task to run. Only called by a task, from the thread running it.
+ *
+ * @param scheduler The scheduler.
+ * @param worker The number of the thread running the calling task.
+ * @param task The new task.
+ */
+void schedulerSpawn(Scheduler* scheduler, int worker, int task);
+
+/**
+ * @brief Runs tasks until all of them, and all the tasks they spawn, are finished.
+ *
+ * The first tasks are shared among the threads. The function returns
+ * when the threads are stopped, and can be called again.
+ *
+ * @param scheduler The scheduler.
+ * @param tasks The first tasks.
+ * @param nbTasks The number of first tasks.
+ */
+void schedulerRun(Scheduler* scheduler, const int* tasks, int nbTasks);
+
+#endif /* WORKSTEALING_H */